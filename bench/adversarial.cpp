@@ -0,0 +1,92 @@
+// Low-entropy keys that std::hash passes through unchanged: sequential IDs, multiples of 4096 and heap addresses.
+#include <benchmark/benchmark.h>
+#include <memory>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::uint64_t SEED = 0xad5e;
+        constexpr std::uint64_t STRIDE = 4096;
+
+        // The identity, declared avalanching so that flashmap uses its bits unmixed: how these keys fared before mixing
+        struct RawHash {
+            using is_avalanching = void;
+
+            template<typename K>
+            std::size_t operator()(const K key) const {
+                if constexpr (std::is_pointer_v<K>) return reinterpret_cast<std::uintptr_t>(key);
+                else return static_cast<std::size_t>(key);
+            }
+        };
+
+        template<typename K, typename Hash, typename Probing>
+        using Map = yulbax::flashmap<K, std::uint64_t, Hash, std::equal_to<K>, std::allocator<std::pair<const K, std::uint64_t>>,
+                                     flashmap_policy<no_stats, auto_layout, Probing>>;
+
+        // What a pointer key points at: allocated one by one, so addresses are spaced by the allocator's size class
+        struct Node {
+            std::array<std::uint64_t, 6> payload{};
+        };
+
+        enum class Pattern { SEQUENTIAL, STRIDE, POINTER };
+
+        // 2 * count keys of one pattern: the first half is inserted, the second half is probed for misses
+        template<typename K>
+        std::vector<K> makePattern(const Pattern pattern, const std::size_t count, std::vector<std::unique_ptr<Node>> & nodes) {
+            std::vector<K> keys;
+            keys.reserve(2 * count);
+            for (std::size_t i = 0; i < 2 * count; ++i) {
+                if constexpr (std::is_pointer_v<K>) {
+                    nodes.push_back(std::make_unique<Node>());
+                    keys.push_back(nodes.back().get());
+                } else {
+                    keys.push_back(static_cast<K>(pattern == Pattern::STRIDE ? i * STRIDE : i));
+                }
+            }
+            return keys;
+        }
+
+        template<typename K, typename Hash, typename Probing, bool Hit>
+        void lookup(benchmark::State & state, const Pattern pattern) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            std::vector<std::unique_ptr<Node>> nodes;
+            const auto keys = makePattern<K>(pattern, count, nodes);
+            Map<K, Hash, Probing> map;
+            for (std::size_t i = 0; i < count; ++i) map.insert(keys[i], i);
+
+            std::vector<K> probes(keys.begin() + static_cast<std::ptrdiff_t>(Hit ? 0 : count),
+                                  keys.begin() + static_cast<std::ptrdiff_t>(Hit ? count : 2 * count));
+            std::ranges::shuffle(probes, std::mt19937_64(SEED));
+
+            for (auto _ : state) {
+                std::size_t found = 0;
+                for (const auto key : probes) found += map.contains(key);
+                benchmark::DoNotOptimize(found);
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+            state.counters["probe_len"] = probeLength(map, probes);
+        }
+
+        template<typename K>
+        void registerPattern(const Pattern pattern, const std::string & keys) {
+            const auto add = [&]<typename Hash, typename Probing>(const std::string & map) {
+                benchmark::RegisterBenchmark(("adversarial_hit/" + map + "/" + keys).c_str(),
+                                             lookup<K, Hash, Probing, true>, pattern)->Arg(1 << 12)->Arg(1 << 16);
+                benchmark::RegisterBenchmark(("adversarial_miss/" + map + "/" + keys).c_str(),
+                                             lookup<K, Hash, Probing, false>, pattern)->Arg(1 << 12)->Arg(1 << 16);
+            };
+            add.template operator()<std::hash<K>, group_linear_probing>("mixed");
+            add.template operator()<std::hash<K>, triangular_probing>("mixed_triangular");
+            add.template operator()<RawHash, group_linear_probing>("raw");
+            add.template operator()<RawHash, triangular_probing>("raw_triangular");
+        }
+
+        const bool registered = [] {
+            registerPattern<std::uint64_t>(Pattern::SEQUENTIAL, "sequential");
+            registerPattern<std::uint64_t>(Pattern::STRIDE, "stride4096");
+            registerPattern<const Node *>(Pattern::POINTER, "pointer");
+            return true;
+        }();
+    }
+}
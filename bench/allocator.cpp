@@ -0,0 +1,46 @@
+// Short-lived per-request maps: global heap vs. a monotonic arena that is released after every request.
+#include <benchmark/benchmark.h>
+#include <memory_resource>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::uint64_t SEED = 0xa11c;
+
+        void requestHeap(benchmark::State & state) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<std::uint64_t>(count, SEED);
+
+            for (auto _ : state) {
+                flash<std::uint64_t, std::uint64_t> map(16);
+                for (const auto key : keys) map.insert(key, key);
+                benchmark::DoNotOptimize(map);
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+        }
+
+        void requestArena(benchmark::State & state) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<std::uint64_t>(count, SEED);
+            std::pmr::monotonic_buffer_resource arena(count * 64);
+
+            for (auto _ : state) {
+                {
+                    yulbax::pmr::flashmap<std::uint64_t, std::uint64_t> map(16, &arena);
+                    for (const auto key : keys) map.insert(key, key);
+                    benchmark::DoNotOptimize(map);
+                }
+                arena.release();
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+        }
+
+        const bool registered = [] {
+            benchmark::RegisterBenchmark("request_map/flashmap/heap", requestHeap)->Arg(1 << 8)->Arg(1 << 12);
+            benchmark::RegisterBenchmark("request_map/flashmap/arena", requestArena)->Arg(1 << 8)->Arg(1 << 12);
+            return true;
+        }();
+    }
+}
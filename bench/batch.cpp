@@ -0,0 +1,86 @@
+// One-at-a-time vs. batched lookups and inserts at table sizes from cache-resident to well past the LLC.
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        using Map = flash<std::uint64_t, std::uint64_t>;
+        constexpr std::size_t PROBES = std::size_t{1} << 18;
+
+        void reportPerOp(benchmark::State & state, const std::size_t opsPerIteration) {
+            state.counters["time/op"] = benchmark::Counter(static_cast<double>(state.iterations() * opsPerIteration),
+                                                           benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        }
+
+        // Half of the probes hit, in random order
+        std::vector<std::uint64_t> makeProbes(const std::vector<std::uint64_t> & keys) {
+            auto probes = makeKeys<std::uint64_t>(PROBES, keys.size() + 1);
+            std::mt19937_64 rng(keys.size());
+            for (std::size_t i = 0; i < PROBES; i += 2) probes[i] = keys[rng() % keys.size()];
+            return probes;
+        }
+
+        enum class Lookup { SINGLE, CONTAINS_MANY, FIND_MANY };
+
+        void lookup(benchmark::State & state, const Lookup mode) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<std::uint64_t>(count, count);
+            Map map(count);
+            for (const auto key : keys) map.insert(key, key);
+            const auto probes = makeProbes(keys);
+
+            const auto found = std::make_unique<bool[]>(PROBES);
+            std::vector<const std::uint64_t *> values(PROBES);
+            const Map & view = map;
+
+            for (auto _ : state) {
+                switch (mode) {
+                    case Lookup::SINGLE:
+                        for (std::size_t i = 0; i < PROBES; ++i) found[i] = view.contains(probes[i]);
+                        break;
+                    case Lookup::CONTAINS_MANY:
+                        view.contains_many(probes, {found.get(), PROBES});
+                        break;
+                    case Lookup::FIND_MANY:
+                        view.find_many(probes, values);
+                        break;
+                }
+                benchmark::DoNotOptimize(found.get());
+                benchmark::DoNotOptimize(values.data());
+            }
+
+            reportPerOp(state, PROBES);
+        }
+
+        void insert(benchmark::State & state, const bool batched) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<std::uint64_t>(count, count);
+            std::vector<std::pair<std::uint64_t, std::uint64_t>> pairs;
+            pairs.reserve(count);
+            for (const auto key : keys) pairs.emplace_back(key, key);
+
+            for (auto _ : state) {
+                Map map(count * 2);
+                if (batched) map.insert_range(pairs);
+                else for (const auto & [key, value] : pairs) map.insert(key, value);
+                benchmark::DoNotOptimize(map);
+            }
+
+            reportPerOp(state, count);
+        }
+
+        const bool registered = [] {
+            const auto sizes = [](benchmark::internal::Benchmark * bench) {
+                bench->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+            };
+            sizes(benchmark::RegisterBenchmark("batch_lookup/single", lookup, Lookup::SINGLE));
+            sizes(benchmark::RegisterBenchmark("batch_lookup/contains_many", lookup, Lookup::CONTAINS_MANY));
+            sizes(benchmark::RegisterBenchmark("batch_lookup/find_many", lookup, Lookup::FIND_MANY));
+            sizes(benchmark::RegisterBenchmark("batch_insert/single", insert, false));
+            sizes(benchmark::RegisterBenchmark("batch_insert/insert_range", insert, true));
+            return true;
+        }();
+    }
+}
@@ -0,0 +1,53 @@
+// Lookup latency after increasing amounts of erase/insert churn at a fixed table size.
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::size_t CAPACITY = std::size_t{1} << 18;
+        constexpr std::size_t LIVE = CAPACITY * 13 / 16;
+
+        // range(0) rounds of churn, each replacing every live key once, run before the timed lookups
+        template<typename Map>
+        void lookupAfterChurn(benchmark::State & state, const bool hit) {
+            const auto rounds = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<std::uint64_t>(LIVE * (rounds + 1), LIVE);
+            Map map(CAPACITY);
+            for (std::size_t i = 0; i < LIVE; ++i) map.insert(keys[i], keys[i]);
+            for (std::size_t i = LIVE; i < keys.size(); ++i) {
+                map.erase(keys[i - LIVE]);
+                map.insert(keys[i], keys[i]);
+            }
+
+            std::vector<std::uint64_t> probes(keys.end() - static_cast<std::ptrdiff_t>(LIVE), keys.end());
+            if (!hit) probes = makeKeys<std::uint64_t>(LIVE, LIVE + 1);
+            std::ranges::shuffle(probes, std::mt19937_64(LIVE));
+
+            for (auto _ : state) {
+                std::size_t found = 0;
+                for (const auto key : probes) found += map.contains(key);
+                benchmark::DoNotOptimize(found);
+            }
+
+            state.counters["probe_len"] = probeLength(map, probes);
+            state.counters["time/op"] = benchmark::Counter(static_cast<double>(state.iterations() * probes.size()),
+                                                           benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        }
+
+        template<typename Map>
+        void registerChurn(const std::string & map) {
+            for (const bool hit : {true, false}) {
+                const std::string name = "churn_lookup/" + map + (hit ? "/hit" : "/miss");
+                benchmark::RegisterBenchmark(name.c_str(), lookupAfterChurn<Map>, hit)
+                    ->ArgName("rounds")->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+            }
+        }
+
+        const bool registered = [] {
+            registerChurn<flash<std::uint64_t, std::uint64_t>>("flashmap");
+            registerChurn<linear<std::uint64_t, std::uint64_t>>("linear_probing");
+            return true;
+        }();
+    }
+}
@@ -0,0 +1,96 @@
+// Read/write mix from 1 to N threads: one mutex around a flashmap vs. the sharded concurrent_flashmap.
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "maps.hpp"
+#include "../concurrentflashmap.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::size_t LIVE = std::size_t{1} << 20;
+        constexpr std::size_t OPS = std::size_t{1} << 14;
+
+        // The status quo this replaces: every operation takes the same lock
+        class locked_flashmap {
+        public:
+            bool insert(const std::uint64_t key, const std::uint64_t value) {
+                std::lock_guard lock(m_Mutex);
+                return m_Map.insert(key, value);
+            }
+
+            bool contains(const std::uint64_t key) {
+                std::lock_guard lock(m_Mutex);
+                return m_Map.contains(key);
+            }
+
+            bool erase(const std::uint64_t key) {
+                std::lock_guard lock(m_Mutex);
+                return m_Map.erase(key);
+            }
+
+        private:
+            std::mutex m_Mutex;
+            flash<std::uint64_t, std::uint64_t> m_Map{LIVE * 2};
+        };
+
+        using sharded = concurrent_flashmap<std::uint64_t, std::uint64_t>;
+
+        template<typename Map>
+        std::unique_ptr<Map> shared;
+
+        template<typename Map>
+        void setup(const benchmark::State &) {
+            if constexpr (std::same_as<Map, sharded>) shared<Map> = std::make_unique<Map>(LIVE * 2);
+            else shared<Map> = std::make_unique<Map>();
+            for (const auto key : makeKeys<std::uint64_t>(LIVE, LIVE)) shared<Map>->insert(key, key);
+        }
+
+        template<typename Map>
+        void teardown(const benchmark::State &) {
+            shared<Map>.reset();
+        }
+
+        // range(0) is the write share in percent; writes alternate between inserting and erasing a thread-private key,
+        // so the live size stays put while the lock sees real modifications
+        template<typename Map>
+        void mixed(benchmark::State & state) {
+            const auto writes = static_cast<std::uint64_t>(state.range(0));
+            const auto reads = makeKeys<std::uint64_t>(OPS, LIVE);
+            const auto own = makeKeys<std::uint64_t>(OPS, LIVE + 1 + static_cast<std::uint64_t>(state.thread_index()));
+            Map & map = *shared<Map>;
+            std::mt19937_64 rng(state.thread_index());
+
+            for (auto _ : state) {
+                std::size_t found = 0;
+                for (std::size_t i = 0; i < OPS; ++i) {
+                    if (rng() % 100 < writes) {
+                        if (i & 1) map.erase(own[i - 1]);
+                        else map.insert(own[i], own[i]);
+                    } else {
+                        found += map.contains(reads[i]);
+                    }
+                }
+                benchmark::DoNotOptimize(found);
+            }
+
+            state.counters["ops/s"] = benchmark::Counter(static_cast<double>(state.iterations() * OPS),
+                                                         benchmark::Counter::kIsRate);
+        }
+
+        template<typename Map>
+        void registerMixed(const std::string & name) {
+            benchmark::RegisterBenchmark(("concurrent/" + name).c_str(), mixed<Map>)
+                ->ArgName("write_pct")->Arg(5)->Arg(50)
+                ->ThreadRange(1, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))
+                ->Setup(setup<Map>)->Teardown(teardown<Map>)
+                ->UseRealTime();
+        }
+
+        const bool registered = [] {
+            registerMixed<locked_flashmap>("locked_flashmap");
+            registerMixed<sharded>("concurrent_flashmap");
+            return true;
+        }();
+    }
+}
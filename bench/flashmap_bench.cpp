@@ -0,0 +1,214 @@
+// Workload suite: flashmap against std::unordered_map and open-addressing maps.
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::uint64_t SEED = 0x5eed;
+
+        void reportMemory(benchmark::State & state) {
+            state.counters["peak_rss_MiB"] = peakRssMiB();
+        }
+
+        template<typename Map, typename Key>
+        void reportProbeLength(benchmark::State & state, const Map & map, const std::vector<Key> & keys) {
+            if constexpr (hasProbeLength<Map>) state.counters["probe_len"] = probeLength(map, keys);
+        }
+
+        void reportNsPerOp(benchmark::State & state, const std::size_t opsPerIteration) {
+            state.counters["time/op"] = benchmark::Counter(static_cast<double>(state.iterations() * opsPerIteration),
+                                                           benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        }
+
+        template<typename Map>
+        Map build(const std::vector<typename Map::key_type> & keys) {
+            Map map;
+            for (const auto & key : keys) insert(map, key, typename Map::mapped_type{});
+            return map;
+        }
+
+        template<typename Map>
+        void insertHeavy(benchmark::State & state) {
+            using Key = typename Map::key_type;
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<Key>(count, SEED);
+            resetPeakRss();
+
+            for (auto _ : state) {
+                Map map;
+                for (const auto & key : keys) insert(map, key, typename Map::mapped_type{});
+                benchmark::DoNotOptimize(map);
+                state.PauseTiming();
+                reportProbeLength(state, map, keys);
+                state.ResumeTiming();
+            }
+
+            reportMemory(state);
+            reportNsPerOp(state, count);
+        }
+
+        // insertHeavy with the final size announced up front: no intermediate rehash
+        template<typename Map>
+        void insertReserved(benchmark::State & state) {
+            using Key = typename Map::key_type;
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<Key>(count, SEED);
+            resetPeakRss();
+
+            for (auto _ : state) {
+                Map map;
+                map.reserve(count);
+                for (const auto & key : keys) insert(map, key, typename Map::mapped_type{});
+                benchmark::DoNotOptimize(map);
+            }
+
+            reportMemory(state);
+            reportNsPerOp(state, count);
+        }
+
+        template<typename Map>
+        void lookup(benchmark::State & state, const bool hit) {
+            using Key = typename Map::key_type;
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<Key>(count, SEED);
+            resetPeakRss();
+            const Map map = build<Map>(keys);
+
+            auto probes = hit ? keys : makeKeys<Key>(count, SEED + 1);
+            std::ranges::shuffle(probes, std::mt19937_64(SEED));
+
+            for (auto _ : state) {
+                std::size_t found = 0;
+                for (const auto & key : probes) found += map.contains(key);
+                benchmark::DoNotOptimize(found);
+            }
+
+            reportProbeLength(state, map, probes);
+            reportMemory(state);
+            reportNsPerOp(state, count);
+        }
+
+        template<typename Map>
+        void lookupHit(benchmark::State & state) { lookup<Map>(state, true); }
+
+        template<typename Map>
+        void lookupMiss(benchmark::State & state) { lookup<Map>(state, false); }
+
+        // Steady-state erase/insert: every operation removes the oldest live key and inserts a fresh one
+        template<typename Map>
+        void churn(benchmark::State & state) {
+            using Key = typename Map::key_type;
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<Key>(count * 4, SEED);
+            resetPeakRss();
+            Map map = build<Map>({keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(count)});
+
+            std::size_t oldest = 0;
+            std::size_t next = count;
+            for (auto _ : state) {
+                for (std::size_t i = 0; i < 1024; ++i) {
+                    map.erase(keys[oldest]);
+                    insert(map, keys[next], typename Map::mapped_type{});
+                    oldest = oldest + 1 == keys.size() ? 0 : oldest + 1;
+                    next = next + 1 == keys.size() ? 0 : next + 1;
+                }
+            }
+
+            reportProbeLength(state, map, keys);
+            reportMemory(state);
+            reportNsPerOp(state, 1024);
+        }
+
+        template<typename Map>
+        void iterate(benchmark::State & state) {
+            using Key = typename Map::key_type;
+            const auto count = static_cast<std::size_t>(state.range(0));
+            resetPeakRss();
+            Map map = build<Map>(makeKeys<Key>(count, SEED));
+
+            for (auto _ : state) {
+                std::size_t visited = 0;
+                forEach(map, [&](auto & kv) {
+                    benchmark::DoNotOptimize(kv.second);
+                    ++visited;
+                });
+                benchmark::DoNotOptimize(visited);
+            }
+
+            reportMemory(state);
+            reportNsPerOp(state, map.size());
+        }
+
+        // Inserts that cross several growth steps while range(1) iterators into the map stay alive
+        template<typename Map>
+        void insertWithLiveIterators(benchmark::State & state) {
+            using Key = typename Map::key_type;
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto live = static_cast<std::size_t>(state.range(1));
+            const auto keys = makeKeys<Key>(count + live, SEED);
+            resetPeakRss();
+
+            for (auto _ : state) {
+                state.PauseTiming();
+                Map map;
+                std::vector<typename StableRef<Map>::type> iterators;
+                iterators.reserve(live);
+                for (std::size_t i = 0; i < live; ++i) {
+                    insert(map, keys[i], typename Map::mapped_type{});
+                    iterators.emplace_back(map.find(keys[i]));
+                }
+                state.ResumeTiming();
+
+                for (std::size_t i = live; i < keys.size(); ++i) insert(map, keys[i], typename Map::mapped_type{});
+                if (!iterators.empty()) benchmark::DoNotOptimize(iterators.front()->second);
+
+                state.PauseTiming();
+                iterators.clear();
+                map = Map();
+                state.ResumeTiming();
+            }
+
+            reportMemory(state);
+            reportNsPerOp(state, count);
+        }
+
+        template<template<typename, typename> class Map, typename Key, typename Value>
+        void registerWorkloads(const std::string & map, const std::string & types) {
+            using M = Map<Key, Value>;
+            const auto name = [&](const char * workload) { return std::string(workload) + "/" + map + "/" + types; };
+
+            benchmark::RegisterBenchmark(name("insert").c_str(), insertHeavy<M>)->Arg(1 << 16)->Arg(1 << 20);
+            benchmark::RegisterBenchmark(name("lookup_hit").c_str(), lookupHit<M>)->Arg(1 << 16)->Arg(1 << 20);
+            benchmark::RegisterBenchmark(name("lookup_miss").c_str(), lookupMiss<M>)->Arg(1 << 16)->Arg(1 << 20);
+            benchmark::RegisterBenchmark(name("churn").c_str(), churn<M>)->Arg(1 << 16)->Arg(1 << 20);
+            benchmark::RegisterBenchmark(name("iterate").c_str(), iterate<M>)->Arg(1 << 16)->Arg(1 << 20);
+        }
+
+        template<template<typename, typename> class Map>
+        void registerMap(const std::string & map) {
+            registerWorkloads<Map, int, int>(map, "int");
+            registerWorkloads<Map, std::uint64_t, std::uint64_t>(map, "u64");
+            registerWorkloads<Map, std::string, std::uint64_t>(map, "string");
+            registerWorkloads<Map, std::uint64_t, Large>(map, "u64_large");
+        }
+
+        const bool registered = [] {
+            registerMap<flash>("flashmap");
+            registerMap<stdmap>("std_unordered");
+            registerMap<linear>("linear_probing");
+#ifdef FLASHMAP_BENCH_ABSL
+            registerMap<abslmap>("absl_flat");
+#endif
+            benchmark::RegisterBenchmark("insert_reserved/flashmap/u64", insertReserved<flash<std::uint64_t, std::uint64_t>>)
+                ->Arg(1 << 16)->Arg(1 << 20);
+            benchmark::RegisterBenchmark("insert_reserved/std_unordered/u64", insertReserved<stdmap<std::uint64_t, std::uint64_t>>)
+                ->Arg(1 << 16)->Arg(1 << 20);
+            benchmark::RegisterBenchmark("insert_live_iterators/flashmap/u64", insertWithLiveIterators<flash<std::uint64_t, std::uint64_t>>)
+                ->Args({1 << 20, 0})->Args({1 << 20, 1 << 10})->Args({1 << 20, 1 << 14});
+            benchmark::RegisterBenchmark("insert_live_iterators/std_unordered/u64", insertWithLiveIterators<stdmap<std::uint64_t, std::uint64_t>>)
+                ->Args({1 << 20, 0})->Args({1 << 20, 1 << 10})->Args({1 << 20, 1 << 14});
+            return true;
+        }();
+    }
+}
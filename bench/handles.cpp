@@ -0,0 +1,64 @@
+// Cost of registration: plain iterators against stable handles, which pay the list bookkeeping every iterator used to.
+#include <benchmark/benchmark.h>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::uint64_t SEED = 0x4a4d;
+
+        using Map = flash<std::uint64_t, std::uint64_t>;
+
+        Map build(const std::vector<std::uint64_t> & keys) {
+            Map map;
+            for (const auto key : keys) map.insert(key, key);
+            return map;
+        }
+
+        // Find and drop the result right away, the common lookup pattern
+        template<typename Ref>
+        void findThenDiscard(benchmark::State & state) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<std::uint64_t>(count, SEED);
+            Map map = build(keys);
+
+            for (auto _ : state) {
+                for (const auto key : keys) {
+                    const Ref ref = map.find(key);
+                    benchmark::DoNotOptimize(ref->second);
+                }
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+        }
+
+        // Full sweep; the handle variant registers one handle per element, as every iterator step used to
+        template<typename Ref>
+        void iterate(benchmark::State & state) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            Map map = build(makeKeys<std::uint64_t>(count, SEED));
+
+            for (auto _ : state) {
+                std::uint64_t sum = 0;
+                for (auto it = map.begin(); it != map.end(); ++it) {
+                    const Ref ref = it;
+                    sum += ref->second;
+                }
+                benchmark::DoNotOptimize(sum);
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+        }
+
+        const bool registered = [] {
+            benchmark::RegisterBenchmark("find_discard/flashmap/iterator", findThenDiscard<Map::iterator>)
+                ->Arg(1 << 12)->Arg(1 << 20);
+            benchmark::RegisterBenchmark("find_discard/flashmap/stable_handle", findThenDiscard<Map::stable_handle>)
+                ->Arg(1 << 12)->Arg(1 << 20);
+            benchmark::RegisterBenchmark("iterate_refs/flashmap/iterator", iterate<Map::iterator>)
+                ->Arg(1 << 12)->Arg(1 << 20);
+            benchmark::RegisterBenchmark("iterate_refs/flashmap/stable_handle", iterate<Map::stable_handle>)
+                ->Arg(1 << 12)->Arg(1 << 20);
+            return true;
+        }();
+    }
+}
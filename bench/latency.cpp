@@ -0,0 +1,50 @@
+// Per-insert latency distribution while growing from an empty map: stop-the-world vs incremental rehashing.
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        double percentile(const std::vector<double> & sorted, const double p) {
+            const auto index = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+            return sorted[index];
+        }
+
+        // Every insert is timed on its own, so the counters show the tail that a full rehash puts on one unlucky call
+        void insertLatency(benchmark::State & state, const bool incremental) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<std::uint64_t>(count, count);
+            std::vector<double> samples;
+            samples.reserve(count * 8);
+
+            for (auto _ : state) {
+                flash<std::uint64_t, std::uint64_t> map(16);
+                map.incremental_rehash(incremental);
+                for (const auto key : keys) {
+                    const auto start = Clock::now();
+                    map.insert(key, key);
+                    const auto stop = Clock::now();
+                    samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+                }
+                benchmark::DoNotOptimize(map);
+            }
+
+            std::ranges::sort(samples);
+            state.counters["p50_ns"] = percentile(samples, 0.5);
+            state.counters["p99_ns"] = percentile(samples, 0.99);
+            state.counters["p999_ns"] = percentile(samples, 0.999);
+            state.counters["max_ns"] = samples.back();
+        }
+
+        const bool registered = [] {
+            benchmark::RegisterBenchmark("insert_latency/flashmap/rehash", insertLatency, false)
+                ->Arg(1 << 16)->Arg(1 << 20)->Iterations(4);
+            benchmark::RegisterBenchmark("insert_latency/flashmap/incremental", insertLatency, true)
+                ->Arg(1 << 16)->Arg(1 << 20)->Iterations(4);
+            return true;
+        }();
+    }
+}
@@ -0,0 +1,52 @@
+// Slot layouts side by side: bytes per entry and lookup cost for hashes interleaved, split off or not stored at all.
+#include <benchmark/benchmark.h>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::uint64_t SEED = 0x1a70;
+
+        template<typename K, typename Layout>
+        using Map = yulbax::flashmap<K, std::uint64_t, std::hash<K>, std::equal_to<K>,
+                                     std::allocator<std::pair<const K, std::uint64_t>>, flashmap_policy<no_stats, Layout>>;
+
+        // Half the keys are inserted; hits probe for those, misses for the other half
+        template<typename K, typename Layout, bool Hit>
+        void lookup(benchmark::State & state) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<K>(2 * count, SEED);
+            Map<K, Layout> map;
+            for (std::size_t i = 0; i < count; ++i) map.insert(keys[2 * i], i);
+
+            for (auto _ : state) {
+                std::size_t found = 0;
+                for (std::size_t i = 0; i < count; ++i) found += map.contains(keys[2 * i + !Hit]);
+                benchmark::DoNotOptimize(found);
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+            state.counters["bytes_per_entry"] = static_cast<double>(map.stats().memory_bytes) / static_cast<double>(map.size());
+        }
+
+        template<typename K>
+        void registerLayouts(const std::string & type) {
+            const auto add = [&]<typename Layout>(const std::string & layout) {
+                benchmark::RegisterBenchmark(("layout_hit/" + layout + "/" + type).c_str(), lookup<K, Layout, true>)
+                    ->Arg(1 << 12)->Arg(1 << 20);
+                benchmark::RegisterBenchmark(("layout_miss/" + layout + "/" + type).c_str(), lookup<K, Layout, false>)
+                    ->Arg(1 << 12)->Arg(1 << 20);
+            };
+            add.template operator()<aos_layout<true>>("aos_hash");
+            add.template operator()<aos_layout<false>>("aos");
+            add.template operator()<soa_layout<true>>("soa_hash");
+            add.template operator()<auto_layout>("auto");
+        }
+
+        const bool registered = [] {
+            registerLayouts<std::uint32_t>("u32");
+            registerLayouts<std::uint64_t>("u64");
+            registerLayouts<std::string>("string");
+            return true;
+        }();
+    }
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../flashmap.hpp"
+
+#if __has_include(<malloc.h>)
+#include <malloc.h>
+#endif
+
+#ifdef FLASHMAP_BENCH_ABSL
+#include <absl/container/flat_hash_map.h>
+#endif
+
+namespace yulbax::bench {
+
+    // The pre-control-byte engine: Status + full hash + KV arrays probed one slot at a time
+    template<typename Key, typename Value, typename Hash = std::hash<Key>>
+    class linear_probing_map {
+        enum class Status : std::uint8_t { FREE, OCCUPIED, DELETED };
+
+    public:
+        using key_type    = Key;
+        using mapped_type = Value;
+
+        explicit linear_probing_map(const std::size_t size = 1024)
+            : m_KVs(std::bit_ceil(size)), m_Statuses(m_KVs.size(), Status::FREE), m_Hashes(m_KVs.size()), m_Count(0), m_Used(0) {}
+
+        bool insert(const Key & key, const Value & value) {
+            if (m_Used >= m_KVs.size() * 7 / 8) rehash(m_Count >= m_KVs.size() * 7 / 16 ? m_KVs.size() * 2 : m_KVs.size());
+
+            const std::size_t hash = m_Hasher(key);
+            std::size_t firstDeleted = m_KVs.size();
+            for (std::size_t pos = hash & mask(); ; pos = (pos + 1) & mask()) {
+                if (m_Statuses[pos] == Status::OCCUPIED) {
+                    if (m_Hashes[pos] == hash && m_KVs[pos].first == key) return false;
+                    continue;
+                }
+                if (m_Statuses[pos] == Status::DELETED) {
+                    if (firstDeleted == m_KVs.size()) firstDeleted = pos;
+                    continue;
+                }
+                if (firstDeleted != m_KVs.size()) pos = firstDeleted;
+                else ++m_Used;
+                m_KVs[pos] = {key, value};
+                m_Statuses[pos] = Status::OCCUPIED;
+                m_Hashes[pos] = hash;
+                ++m_Count;
+                return true;
+            }
+        }
+
+        [[nodiscard]] bool contains(const Key & key) const {
+            return findIndex(key) != m_KVs.size();
+        }
+
+        bool erase(const Key & key) {
+            const std::size_t pos = findIndex(key);
+            if (pos == m_KVs.size()) return false;
+            m_Statuses[pos] = Status::DELETED;
+            --m_Count;
+            return true;
+        }
+
+        template<typename F>
+        void for_each(F && fn) {
+            for (std::size_t i = 0; i < m_KVs.size(); ++i)
+                if (m_Statuses[i] == Status::OCCUPIED) fn(m_KVs[i]);
+        }
+
+        [[nodiscard]] std::size_t probe_length(const Key & key) const {
+            const std::size_t hash = m_Hasher(key);
+            std::size_t probes = 1;
+            for (std::size_t pos = hash & mask(); m_Statuses[pos] != Status::FREE; pos = (pos + 1) & mask(), ++probes) {
+                if (m_Statuses[pos] == Status::OCCUPIED && m_Hashes[pos] == hash && m_KVs[pos].first == key) break;
+            }
+            return probes;
+        }
+
+        [[nodiscard]] std::size_t size() const { return m_Count; }
+
+    private:
+        [[nodiscard]] std::size_t mask() const { return m_KVs.size() - 1; }
+
+        [[nodiscard]] std::size_t findIndex(const Key & key) const {
+            const std::size_t hash = m_Hasher(key);
+            for (std::size_t pos = hash & mask(); m_Statuses[pos] != Status::FREE; pos = (pos + 1) & mask()) {
+                if (m_Statuses[pos] == Status::OCCUPIED && m_Hashes[pos] == hash && m_KVs[pos].first == key) return pos;
+            }
+            return m_KVs.size();
+        }
+
+        void rehash(const std::size_t size) {
+            linear_probing_map bigger(size);
+            for_each([&](auto & kv) { bigger.insert(kv.first, kv.second); });
+            *this = std::move(bigger);
+        }
+
+        std::vector<std::pair<Key, Value>> m_KVs;
+        std::vector<Status> m_Statuses;
+        std::vector<std::size_t> m_Hashes;
+        std::size_t m_Count;
+        std::size_t m_Used;
+        [[no_unique_address]] Hash m_Hasher;
+    };
+
+    template<typename K, typename V> using flash   = yulbax::flashmap<K, V>;
+    template<typename K, typename V> using stdmap  = std::unordered_map<K, V>;
+    template<typename K, typename V> using linear  = linear_probing_map<K, V>;
+#ifdef FLASHMAP_BENCH_ABSL
+    template<typename K, typename V> using abslmap = absl::flat_hash_map<K, V>;
+#endif
+
+    struct Large {
+        std::array<std::uint64_t, 32> words{};
+    };
+
+    // UNIFORM ACCESS
+    template<typename Map, typename K, typename V>
+    bool insert(Map & map, K && key, V && value) {
+        if constexpr (requires { { map.insert(key, value) } -> std::same_as<bool>; })
+            return map.insert(std::forward<K>(key), std::forward<V>(value));
+        else
+            return map.emplace(std::forward<K>(key), std::forward<V>(value)).second;
+    }
+
+    template<typename Map, typename F>
+    void forEach(Map & map, F && fn) {
+        if constexpr (requires { map.for_each(fn); })
+            map.for_each(fn);
+        else
+            for (auto & kv : map) fn(kv);
+    }
+
+    // What a caller keeps to reach an element across later inserts: flashmap iterators do not survive growth, so it
+    // hands out registered handles instead; node-based maps keep their iterators valid on their own
+    template<typename Map>
+    struct StableRef { using type = typename Map::iterator; };
+
+    template<typename Map> requires requires { typename Map::stable_handle; }
+    struct StableRef<Map> { using type = typename Map::stable_handle; };
+
+    template<typename Map>
+    constexpr bool hasProbeLength = requires(const Map & map, const typename Map::key_type & key) { map.probe_length(key); }
+                                 || requires(const Map & map, const typename Map::key_type & key) { map.bucket_size(map.bucket(key)); };
+
+    template<typename Map, typename Key>
+    double probeLength(const Map & map, const std::vector<Key> & keys) {
+        const std::size_t sample = std::min<std::size_t>(keys.size(), 4096);
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < sample; ++i) {
+            if constexpr (requires { map.probe_length(keys[i]); })
+                total += map.probe_length(keys[i]);
+            else
+                total += map.bucket_size(map.bucket(keys[i]));
+        }
+        return sample ? static_cast<double>(total) / static_cast<double>(sample) : 0.0;
+    }
+
+    // KEYS
+    template<typename Key>
+    Key makeKey(std::uint64_t random) {
+        if constexpr (std::same_as<Key, std::string>)
+            return "user:" + std::to_string(random);
+        else
+            return static_cast<Key>(random);
+    }
+
+    template<typename Key>
+    std::vector<Key> makeKeys(const std::size_t count, const std::uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        std::vector<Key> keys;
+        keys.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) keys.push_back(makeKey<Key>(rng()));
+        return keys;
+    }
+
+    // MEMORY
+    // Linux only: hands cached heap back to the OS, then restarts the VmHWM high-water mark from the current RSS
+    inline void resetPeakRss() {
+#if defined(__GLIBC__)
+        malloc_trim(0);
+#endif
+        std::ofstream("/proc/self/clear_refs") << "5";
+    }
+
+    inline double peakRssMiB() {
+        std::ifstream status("/proc/self/status");
+        for (std::string line; std::getline(status, line); ) {
+            if (line.starts_with("VmHWM:")) return std::stod(line.substr(6)) / 1024.0;
+        }
+        return 0.0;
+    }
+}
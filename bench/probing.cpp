@@ -0,0 +1,51 @@
+// Group probing, group-linear and triangular, vs. the former slot-by-slot linear prober at fixed load factors.
+#include <benchmark/benchmark.h>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::size_t CAPACITY = std::size_t{1} << 21;
+
+        template<typename K, typename V>
+        using triangular = yulbax::flashmap<K, V, std::hash<K>, std::equal_to<K>, std::allocator<std::pair<const K, V>>,
+                                            flashmap_policy<no_stats, auto_layout, triangular_probing>>;
+
+        // range(0) is the load factor in thousandths; both tables are pre-sized so neither grows
+        template<typename Map>
+        void probeAtLoad(benchmark::State & state, const bool hit) {
+            const auto count = static_cast<std::size_t>(state.range(0)) * CAPACITY / 1000;
+            const auto keys = makeKeys<std::uint64_t>(count, count);
+            Map map(CAPACITY);
+            for (const auto key : keys) map.insert(key, key);
+
+            auto probes = hit ? keys : makeKeys<std::uint64_t>(count, count + 1);
+            std::ranges::shuffle(probes, std::mt19937_64(count));
+
+            for (auto _ : state) {
+                std::size_t found = 0;
+                for (const auto key : probes) found += map.contains(key);
+                benchmark::DoNotOptimize(found);
+            }
+
+            state.counters["probe_len"] = probeLength(map, probes);
+            state.counters["time/op"] = benchmark::Counter(static_cast<double>(state.iterations() * probes.size()),
+                                                           benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        }
+
+        template<typename Map>
+        void registerProbing(const std::string & engine) {
+            for (const bool hit : {true, false}) {
+                const std::string name = "probing/" + engine + (hit ? "/hit" : "/miss");
+                benchmark::RegisterBenchmark(name.c_str(), probeAtLoad<Map>, hit)
+                    ->ArgName("load_permille")->Arg(500)->Arg(625)->Arg(750)->Arg(875);
+            }
+        }
+
+        const bool registered = [] {
+            registerProbing<linear<std::uint64_t, std::uint64_t>>("linear");
+            registerProbing<flash<std::uint64_t, std::uint64_t>>("group");
+            registerProbing<triangular<std::uint64_t, std::uint64_t>>("triangular");
+            return true;
+        }();
+    }
+}
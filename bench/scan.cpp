@@ -0,0 +1,87 @@
+// Full-table scans: range-for over dense and sparse tables, and parallel_for_each / parallel_reduce on 1..N workers.
+#include <benchmark/benchmark.h>
+#include <thread>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::uint64_t SEED = 0x5ca7;
+
+        // DENSE is filled up to the growth threshold of a count-slot table (7/8 full); SPARSE then had 95% of that
+        // erased; GROWN was rehashed to 8x its slots, as after reserving for a peak that never came
+        enum class Fill { DENSE, SPARSE, GROWN };
+
+        flash<std::uint64_t, std::uint64_t> makeMap(const std::size_t count, const Fill fill) {
+            const auto keys = makeKeys<std::uint64_t>(count, SEED);
+            flash<std::uint64_t, std::uint64_t> map(count);
+            const auto limit = static_cast<std::size_t>(static_cast<double>(map.bucket_count()) * map.max_load_factor());
+            std::size_t inserted = 0;
+            for (; inserted + 1 < limit; ++inserted) map.insert(keys[inserted], keys[inserted]);
+            if (fill == Fill::SPARSE) {
+                for (std::size_t i = 0; i < inserted; ++i) {
+                    if (i % 20) map.erase(keys[i]);
+                }
+            } else if (fill == Fill::GROWN) {
+                map.rehash(map.bucket_count() * 8);
+            }
+            return map;
+        }
+
+        void iterate(benchmark::State & state, const Fill fill) {
+            const auto map = makeMap(static_cast<std::size_t>(state.range(0)), fill);
+
+            for (auto _ : state) {
+                std::uint64_t sum = 0;
+                for (const auto & [key, value] : map) sum += value;
+                benchmark::DoNotOptimize(sum);
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * map.size()));
+            state.counters["slots"] = static_cast<double>(map.bucket_count());
+        }
+
+        // range(1) is the number of workers
+        void reduce(benchmark::State & state, const Fill fill) {
+            const auto map = makeMap(static_cast<std::size_t>(state.range(0)), fill);
+            const auto threads = static_cast<std::size_t>(state.range(1));
+
+            for (auto _ : state) {
+                const std::uint64_t sum = map.parallel_reduce(std::uint64_t{0}, std::plus<>{},
+                                                              [](const auto & kv) { return kv.second; }, threads);
+                benchmark::DoNotOptimize(sum);
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * map.size()));
+        }
+
+        // Expiry-style pass: every value is read and rewritten in place
+        void forEach(benchmark::State & state) {
+            auto map = makeMap(static_cast<std::size_t>(state.range(0)), Fill::DENSE);
+            const auto threads = static_cast<std::size_t>(state.range(1));
+
+            for (auto _ : state) {
+                map.parallel_for_each([](auto & kv) { kv.second = kv.second * 3 + 1; }, threads);
+                benchmark::ClobberMemory();
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * map.size()));
+        }
+
+        const bool registered = [] {
+            const auto workers = static_cast<std::int64_t>(std::max(std::thread::hardware_concurrency(), 1u));
+            const std::vector<std::int64_t> threads = workers > 1 ? std::vector<std::int64_t>{1, 2, workers}
+                                                                  : std::vector<std::int64_t>{1, 2};
+
+            for (const auto & [name, fill] : {std::pair{"dense", Fill::DENSE}, std::pair{"sparse", Fill::SPARSE},
+                                              std::pair{"grown", Fill::GROWN}}) {
+                benchmark::RegisterBenchmark((std::string("scan_iterate/flashmap/") + name).c_str(), iterate, fill)
+                    ->Arg(1 << 16)->Arg(1 << 22);
+                benchmark::RegisterBenchmark((std::string("scan_reduce/flashmap/") + name).c_str(), reduce, fill)
+                    ->ArgNames({"n", "threads"})->ArgsProduct({{1 << 22}, threads})->UseRealTime();
+            }
+            benchmark::RegisterBenchmark("scan_for_each/flashmap/dense", forEach)
+                ->ArgNames({"n", "threads"})->ArgsProduct({{1 << 22}, threads})->UseRealTime();
+            return true;
+        }();
+    }
+}
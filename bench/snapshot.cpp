@@ -0,0 +1,72 @@
+// Cold start of a prebuilt table: rebuilding it by insertion, loading a snapshot, and mapping the snapshot.
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include "../flashmapview.hpp"
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::uint64_t SEED = 0x5a75;
+        constexpr std::size_t LOOKUPS = 1 << 10;
+
+        using Map = flash<std::uint64_t, std::uint64_t>;
+
+        std::filesystem::path snapshotFor(const std::vector<std::uint64_t> & keys) {
+            const auto path = std::filesystem::temp_directory_path() / ("flashmap_bench_" + std::to_string(keys.size()) + ".snap");
+            Map map;
+            for (const auto key : keys) map.insert(key, key);
+            map.save(path);
+            return path;
+        }
+
+        // Every variant ends with the same handful of lookups, so the view pays for the pages it touches
+        template<typename M>
+        void lookups(const M & map, const std::vector<std::uint64_t> & keys) {
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i < LOOKUPS; ++i) sum += map.at(keys[i * 7919 % keys.size()]);
+            benchmark::DoNotOptimize(sum);
+        }
+
+        void rebuild(benchmark::State & state) {
+            const auto keys = makeKeys<std::uint64_t>(static_cast<std::size_t>(state.range(0)), SEED);
+
+            for (auto _ : state) {
+                Map map;
+                map.reserve(keys.size());
+                for (const auto key : keys) map.insert(key, key);
+                lookups(map, keys);
+            }
+        }
+
+        void load(benchmark::State & state) {
+            const auto keys = makeKeys<std::uint64_t>(static_cast<std::size_t>(state.range(0)), SEED);
+            const auto path = snapshotFor(keys);
+
+            for (auto _ : state) {
+                const Map map = Map::load(path);
+                lookups(map, keys);
+            }
+
+            std::filesystem::remove(path);
+        }
+
+        void view(benchmark::State & state) {
+            const auto keys = makeKeys<std::uint64_t>(static_cast<std::size_t>(state.range(0)), SEED);
+            const auto path = snapshotFor(keys);
+
+            for (auto _ : state) {
+                const flashmap_view<std::uint64_t, std::uint64_t> map(path);
+                lookups(map, keys);
+            }
+
+            std::filesystem::remove(path);
+        }
+
+        const bool registered = [] {
+            benchmark::RegisterBenchmark("cold_start/flashmap/rebuild", rebuild)->Arg(1 << 16)->Arg(1 << 20);
+            benchmark::RegisterBenchmark("cold_start/flashmap/load", load)->Arg(1 << 16)->Arg(1 << 20);
+            benchmark::RegisterBenchmark("cold_start/flashmap/view", view)->Arg(1 << 16)->Arg(1 << 20);
+            return true;
+        }();
+    }
+}
@@ -0,0 +1,51 @@
+// Price of instrumentation: lookups and inserts with the stats policy off and on.
+#include <benchmark/benchmark.h>
+#include "maps.hpp"
+
+namespace yulbax::bench {
+    namespace {
+        constexpr std::uint64_t SEED = 0x57a7;
+
+        template<typename Stats>
+        using Map = yulbax::flashmap<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>, std::equal_to<std::uint64_t>,
+                                     std::allocator<std::pair<const std::uint64_t, std::uint64_t>>, flashmap_policy<Stats>>;
+
+        template<typename Stats>
+        void lookup(benchmark::State & state) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<std::uint64_t>(count, SEED);
+            Map<Stats> map;
+            for (std::size_t i = 0; i < count; i += 2) map.insert(keys[i], keys[i]);
+
+            for (auto _ : state) {
+                std::size_t found = 0;
+                for (const auto key : keys) found += map.contains(key);
+                benchmark::DoNotOptimize(found);
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+        }
+
+        template<typename Stats>
+        void insert(benchmark::State & state) {
+            const auto count = static_cast<std::size_t>(state.range(0));
+            const auto keys = makeKeys<std::uint64_t>(count, SEED);
+
+            for (auto _ : state) {
+                Map<Stats> map;
+                for (const auto key : keys) map.insert(key, key);
+                benchmark::DoNotOptimize(map);
+            }
+
+            state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+        }
+
+        const bool registered = [] {
+            benchmark::RegisterBenchmark("stats_lookup/flashmap/no_stats", lookup<no_stats>)->Arg(1 << 12)->Arg(1 << 20);
+            benchmark::RegisterBenchmark("stats_lookup/flashmap/collect_stats", lookup<collect_stats>)->Arg(1 << 12)->Arg(1 << 20);
+            benchmark::RegisterBenchmark("stats_insert/flashmap/no_stats", insert<no_stats>)->Arg(1 << 12)->Arg(1 << 20);
+            benchmark::RegisterBenchmark("stats_insert/flashmap/collect_stats", insert<collect_stats>)->Arg(1 << 12)->Arg(1 << 20);
+            return true;
+        }();
+    }
+}
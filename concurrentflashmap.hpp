@@ -0,0 +1,78 @@
+#pragma once
+
+#include <bit>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include "flashmap.hpp"
+
+namespace yulbax {
+
+    // Shards of plain flashmaps, each behind its own reader/writer lock. Shards only ever go through the map's
+    // internal slot-index paths, so no iterator or handle can outlive a shard lock.
+    template<typename Key,
+             typename Value,
+             typename Hash = std::hash<Key>,
+             typename KeyEqual = std::equal_to<Key>>
+             requires concepts::hashable<Key, Hash>
+
+    class concurrent_flashmap {
+
+        using Map      = flashmap<Key, Value, Hash, KeyEqual>;
+        using HashType = typename Map::HashType;
+
+        static constexpr std::size_t DEFAULT_SIZE = 1 << 16;
+        static constexpr std::size_t DEFAULT_SHARDS = 64;
+
+        // Own cache line per shard so that a writer on one lock does not slow readers of the next
+        struct alignas(64) Shard {
+            mutable std::shared_mutex mutex;
+            Map map;
+        };
+
+    public:
+
+        using key_type    = Key;
+        using mapped_type = Value;
+
+        explicit concurrent_flashmap(std::size_t size = DEFAULT_SIZE, std::size_t shards = DEFAULT_SHARDS);
+
+        concurrent_flashmap(const concurrent_flashmap &) = delete;
+        concurrent_flashmap & operator=(const concurrent_flashmap &) = delete;
+
+        template<typename K, typename V>
+        bool insert(K && key, V && value);
+
+        // Inserts value if key is absent, otherwise calls fn(Value &) on the stored value; both under the write lock
+        template<typename K, typename V, typename F>
+        bool upsert(K && key, V && value, F && fn);
+
+        [[nodiscard]] std::optional<Value> find(const Key & key) const;
+        [[nodiscard]] bool contains(const Key & key) const;
+
+        // Calls fn on the value in place while the shard is locked; returns whether key was found
+        template<typename F>
+        bool visit(const Key & key, F && fn) const;
+        template<typename F>
+        bool visit(const Key & key, F && fn);
+
+        bool erase(const Key & key);
+
+        // Not a snapshot: shards are counted one after another
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] std::size_t shard_count() const;
+
+        void clear();
+        void incremental_rehash(bool enabled);
+
+    private:
+        [[nodiscard]] Shard & shardFor(HashType hash) const;
+
+        std::size_t m_ShardBits;
+        std::unique_ptr<Shard[]> m_Shards;
+        Hash m_Hasher;
+    };
+
+    #include "concurrentflashmap.tpp"
+}
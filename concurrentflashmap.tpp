@@ -0,0 +1,124 @@
+#pragma once
+
+// PUBLIC METHODS
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+concurrent_flashmap<Key, Value, Hash, KeyEqual>::concurrent_flashmap(const std::size_t size, const std::size_t shards)
+    : m_ShardBits(std::countr_zero(std::bit_ceil(std::max<std::size_t>(shards, 1)))),
+      m_Shards(new Shard[std::size_t{1} << m_ShardBits]), m_Hasher() {
+    const std::size_t shardSize = std::max<std::size_t>(size >> m_ShardBits, 1);
+    for (std::size_t i = 0; i < shard_count(); ++i) m_Shards[i].map = Map(shardSize);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K, typename V>
+bool concurrent_flashmap<Key, Value, Hash, KeyEqual>::insert(K && key, V && value) {
+    const HashType hash = m_Hasher(key);
+    Shard & shard = shardFor(hash);
+    std::unique_lock lock(shard.mutex);
+    return shard.map.emplaceHashed(hash, std::forward<K>(key), std::forward<V>(value)).second;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K, typename V, typename F>
+bool concurrent_flashmap<Key, Value, Hash, KeyEqual>::upsert(K && key, V && value, F && fn) {
+    const HashType hash = m_Hasher(key);
+    Shard & shard = shardFor(hash);
+    std::unique_lock lock(shard.mutex);
+    auto [pos, inserted] = shard.map.emplaceHashed(hash, std::forward<K>(key), std::forward<V>(value));
+    if (!inserted) fn(shard.map.kvAt(pos).second);
+    return inserted;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+std::optional<Value> concurrent_flashmap<Key, Value, Hash, KeyEqual>::find(const Key & key) const {
+    const HashType hash = m_Hasher(key);
+    const Shard & shard = shardFor(hash);
+    std::shared_lock lock(shard.mutex);
+    const std::size_t pos = shard.map.findIndex(key, hash);
+    if (pos == shard.map.endIndex()) return std::nullopt;
+    return shard.map.kvAt(pos).second;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+bool concurrent_flashmap<Key, Value, Hash, KeyEqual>::contains(const Key & key) const {
+    const HashType hash = m_Hasher(key);
+    const Shard & shard = shardFor(hash);
+    std::shared_lock lock(shard.mutex);
+    return shard.map.findIndex(key, hash) != shard.map.endIndex();
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+template<typename F>
+bool concurrent_flashmap<Key, Value, Hash, KeyEqual>::visit(const Key & key, F && fn) const {
+    const HashType hash = m_Hasher(key);
+    const Shard & shard = shardFor(hash);
+    std::shared_lock lock(shard.mutex);
+    const std::size_t pos = shard.map.findIndex(key, hash);
+    if (pos == shard.map.endIndex()) return false;
+    fn(std::as_const(shard.map.kvAt(pos).second));
+    return true;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+template<typename F>
+bool concurrent_flashmap<Key, Value, Hash, KeyEqual>::visit(const Key & key, F && fn) {
+    const HashType hash = m_Hasher(key);
+    Shard & shard = shardFor(hash);
+    std::unique_lock lock(shard.mutex);
+    const std::size_t pos = shard.map.findIndex(key, hash);
+    if (pos == shard.map.endIndex()) return false;
+    fn(shard.map.kvAt(pos).second);
+    return true;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+bool concurrent_flashmap<Key, Value, Hash, KeyEqual>::erase(const Key & key) {
+    const HashType hash = m_Hasher(key);
+    Shard & shard = shardFor(hash);
+    std::unique_lock lock(shard.mutex);
+    const std::size_t pos = shard.map.findIndex(key, hash);
+    if (pos == shard.map.endIndex()) return false;
+    shard.map.eraseAt(pos);
+    return true;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t concurrent_flashmap<Key, Value, Hash, KeyEqual>::size() const {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < shard_count(); ++i) {
+        std::shared_lock lock(m_Shards[i].mutex);
+        total += m_Shards[i].map.size();
+    }
+    return total;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t concurrent_flashmap<Key, Value, Hash, KeyEqual>::shard_count() const {
+    return std::size_t{1} << m_ShardBits;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+void concurrent_flashmap<Key, Value, Hash, KeyEqual>::clear() {
+    for (std::size_t i = 0; i < shard_count(); ++i) {
+        std::unique_lock lock(m_Shards[i].mutex);
+        m_Shards[i].map.clear();
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+void concurrent_flashmap<Key, Value, Hash, KeyEqual>::incremental_rehash(const bool enabled) {
+    for (std::size_t i = 0; i < shard_count(); ++i) {
+        std::unique_lock lock(m_Shards[i].mutex);
+        m_Shards[i].map.incremental_rehash(enabled);
+    }
+}
+
+// PRIVATE METHODS
+// The shard index comes from the bits of the mixed hash just below the control-byte fragment, so keys in one shard still
+// spread over all fragments and, through the low bits, over all groups
+template<typename Key, typename Value, typename Hash, typename KeyEqual> requires yulbax::concepts::hashable<Key, Hash>
+typename concurrent_flashmap<Key, Value, Hash, KeyEqual>::Shard &
+concurrent_flashmap<Key, Value, Hash, KeyEqual>::shardFor(const HashType hash) const {
+    const std::uint64_t mixed = container::flashmap::impl::mix<Hash>(hash);
+    return m_Shards[(mixed >> (57 - m_ShardBits)) & (shard_count() - 1)];
+}
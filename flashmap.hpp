@@ -1,51 +1,112 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <exception>
+#include <functional>
+#include <filesystem>
+#include <fstream>
 #include <list>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
 #include <vector>
 #include <ranges>
+#include <span>
 #include <variant>
 #include "flashmap.hpp"
 #include "flashmapconcepts.hpp"
 #include "flashmapimpl.hpp"
+#include "flashmapgroup.hpp"
+#include "flashmappolicy.hpp"
+#include "flashmapsnapshot.hpp"
+#include "flashmapstats.hpp"
 #include "listallocator.hpp"
 
 namespace yulbax {
 
+    template<typename Key, typename Value, typename Hash, typename KeyEqual> requires concepts::hashable<Key, Hash>
+    class concurrent_flashmap;
+
     template<typename Key,
              typename Value,
-             typename Hash = std::hash<Key>>
+             typename Hash = std::hash<Key>,
+             typename KeyEqual = std::equal_to<Key>,
+             typename Allocator = std::allocator<std::pair<const Key, Value>>,
+             typename Policy = flashmap_policy<>>
              requires concepts::hashable<Key, Hash>
 
     class flashmap {
 
+        using Group    = container::flashmap::impl::Group;
+        using Probing  = typename Policy::probing;
+        using ProbeSeq = container::flashmap::impl::ProbeSeq<Probing>;
+
         static constexpr std::size_t DEFAULT_SIZE = 1024;
+        static constexpr std::size_t MIN_SIZE = Group::WIDTH;
+        // Largest power of two a std::size_t holds; sizes past it throw std::length_error
+        static constexpr std::size_t MAX_SIZE = std::bit_floor(~std::size_t{0});
+        // Old-table slots moved per insert while migrating; the next growth is at least 7/8 of the old size inserts away
+        static constexpr std::size_t MIGRATE_SLOTS = 4;
+        // Default for max_load_factor()
         static constexpr float LOAD_FACTOR = 0.875;
+        // Probes hashed and prefetched together by the batch operations
+        static constexpr std::size_t PREFETCH_BATCH = 32;
+        // Slots a parallel scan worker claims at a time; a multiple of every group width
+        static constexpr std::size_t PARALLEL_CHUNK = 1 << 14;
 
         using HashType = decltype(std::declval<Hash>()(std::declval<Key>()));
-        using Status   = container::flashmap::impl::Status;
-        using Data     = container::flashmap::impl::Vectors<Key, Value, HashType>;
+        using Control  = container::flashmap::impl::Control;
+        using Layout   = typename container::flashmap::impl::ResolveLayout<typename Policy::layout, Key>::type;
+        using Data     = container::flashmap::impl::Vectors<Key, Value, HashType, Allocator, Layout>;
+        using Traits   = std::allocator_traits<Allocator>;
+        using Stats    = container::flashmap::impl::Stats<typename Policy::stats>;
+
+        // Bytes a rehash copies per element it moves, reported by stats()
+        static constexpr std::size_t MOVED_BYTES = Data::SLOT_BYTES;
 
         template<typename IteratorType, typename MapType>
         class Iterator;
-        using IteratorPtr = std::variant<Iterator<Value, flashmap>*, Iterator<const Value, const flashmap>*>;
+        template<typename HandleType, typename MapType>
+        class Handle;
+        using HandlePtr   = std::variant<Handle<Value, flashmap>*, Handle<const Value, const flashmap>*>;
+        using HandleAlloc = container::allocator::chunk_list_allocator<HandlePtr, typename Traits::template rebind_alloc<HandlePtr>>;
+        using HandleList  = std::list<HandlePtr, HandleAlloc>;
 
     public:
 
         using key_type       = Key;
         using mapped_type    = Value;
         using value_type     = std::pair<const Key, Value>;
-        using iterator       = Iterator<Value, flashmap>;
-        using const_iterator = Iterator<const Value, const flashmap>;
-
-        explicit flashmap(std::size_t size = DEFAULT_SIZE);
+        using hasher         = Hash;
+        using key_equal      = KeyEqual;
+        using allocator_type = Allocator;
+        using iterator            = Iterator<Value, flashmap>;
+        using const_iterator      = Iterator<const Value, const flashmap>;
+        using stable_handle       = Handle<Value, flashmap>;
+        using const_stable_handle = Handle<const Value, const flashmap>;
+
+        explicit flashmap(std::size_t size = DEFAULT_SIZE, const Allocator & alloc = Allocator());
+        explicit flashmap(const Allocator & alloc);
         flashmap(const flashmap & other);
+        flashmap(const flashmap & other, const Allocator & alloc);
         flashmap & operator=(const flashmap & other);
         flashmap(flashmap && other) noexcept;
-        flashmap & operator=(flashmap && other) noexcept;
+        flashmap & operator=(flashmap && other) noexcept(Traits::propagate_on_container_move_assignment::value
+                                                      || Traits::is_always_equal::value);
         ~flashmap();
 
         template<typename InputIt> requires concepts::inititerator<InputIt, Key, Value>
-        flashmap(InputIt first, InputIt last);
+        flashmap(InputIt first, InputIt last, const Allocator & alloc = Allocator());
+
+        [[nodiscard]] Allocator get_allocator() const;
 
         template<typename K, typename V>
         bool insert(K && key, V && value);
@@ -53,63 +114,213 @@ namespace yulbax {
         template<typename K, typename V>
         std::pair<iterator, bool> emplace(K && key, V && value);
 
+        template<typename... KeyArgs, typename... ValueArgs>
+        std::pair<iterator, bool> emplace(std::piecewise_construct_t, std::tuple<KeyArgs...> keyArgs,
+                                          std::tuple<ValueArgs...> valueArgs);
+
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace(K && key, Args &&... args);
+
+        template<typename K, typename V>
+        bool insert_with_hash(K && key, V && value, HashType hash);
+
+        template<typename Range> requires std::ranges::forward_range<Range>
+                                       && concepts::inititerator<std::ranges::iterator_t<Range>, Key, Value>
+        std::size_t insert_range(Range && range);
+
         template<typename K>
         Value & operator[](K && key);
 
         Value & at(const Key & key);
         [[nodiscard]] const Value & at(const Key & key) const;
+        template<typename K> requires concepts::transparentkey<K, Key, Hash, KeyEqual>
+        Value & at(const K & key);
+        template<typename K> requires concepts::transparentkey<K, Key, Hash, KeyEqual>
+        [[nodiscard]] const Value & at(const K & key) const;
 
         [[nodiscard]] bool contains(const Key & key) const;
+        template<typename K> requires concepts::transparentkey<K, Key, Hash, KeyEqual>
+        [[nodiscard]] bool contains(const K & key) const;
+        template<typename K> requires concepts::lookupkey<K, Key, Hash, KeyEqual>
+        [[nodiscard]] bool contains(const K & key, HashType hash) const;
+
+        void find_many(std::span<const Key> keys, std::span<Value *> out);
+        void find_many(std::span<const Key> keys, std::span<const Value *> out) const;
+        void contains_many(std::span<const Key> keys, std::span<bool> out) const;
 
         [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] std::size_t bucket_count() const;
+
+        [[nodiscard]] float load_factor() const;
+        [[nodiscard]] float max_load_factor() const;
+        void max_load_factor(float factor);
+
+        void reserve(std::size_t count);
+        void rehash(std::size_t buckets);
+        void shrink_to_fit();
+
+        [[nodiscard]] std::size_t probe_length(const Key & key) const;
+
+        // Counters are only collected with flashmap_policy<collect_stats>; the rest is read off the table on demand
+        [[nodiscard]] flashmap_stats stats() const;
+        void reset_stats();
+        void dump_layout(std::ostream & out) const;
 
         bool erase(const Key & key);
+        template<typename K> requires concepts::transparentkey<K, Key, Hash, KeyEqual>
+        bool erase(const K & key);
         bool erase(iterator & it);
+        bool erase(stable_handle & handle);
 
         void clear();
 
+        void incremental_rehash(bool enabled);
+        [[nodiscard]] bool incremental_rehash() const;
+
+        // Raw table snapshots for trivially copyable types; flashmap_view serves them without loading
+        void save(const std::filesystem::path & path) const
+            requires std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>;
+        static flashmap load(const std::filesystem::path & path, const Allocator & alloc = Allocator())
+            requires std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>;
+
         iterator find(const Key & key);
         [[nodiscard]] const_iterator find(const Key & key) const;
+        template<typename K> requires concepts::transparentkey<K, Key, Hash, KeyEqual>
+        iterator find(const K & key);
+        template<typename K> requires concepts::transparentkey<K, Key, Hash, KeyEqual>
+        [[nodiscard]] const_iterator find(const K & key) const;
+        template<typename K> requires concepts::lookupkey<K, Key, Hash, KeyEqual>
+        iterator find(const K & key, HashType hash);
+        template<typename K> requires concepts::lookupkey<K, Key, Hash, KeyEqual>
+        [[nodiscard]] const_iterator find(const K & key, HashType hash) const;
+
+        [[nodiscard]] Hash hash_function() const;
+        [[nodiscard]] KeyEqual key_eq() const;
 
         iterator begin();
         [[nodiscard]] const_iterator begin() const;
 
-        iterator & end();
-        [[nodiscard]] const const_iterator & end() const;
+        iterator end();
+        [[nodiscard]] const_iterator end() const;
+
+        // Full-table scans split over threads workers, std::thread::hardware_concurrency() by default. Every element is
+        // visited once, by any of the workers: fn must be safe to call concurrently, and the map must not be modified
+        // until the call returns. The first exception thrown by fn is rethrown once all workers have stopped.
+        template<typename F>
+        void parallel_for_each(F && fn, std::size_t threads = 0);
+        template<typename F>
+        void parallel_for_each(F && fn, std::size_t threads = 0) const;
+
+        // init combined with transform(element) of every element in slot order; reduce only needs to be associative
+        template<typename T, typename Reduce, typename Transform>
+        [[nodiscard]] T parallel_reduce(T init, Reduce && reduce, Transform && transform, std::size_t threads = 0) const;
 
     private:
-        void rehash();
+        void grow();
+        void resize(std::size_t newSize);
+        [[nodiscard]] static std::size_t tableSize(std::size_t slots);
+        [[nodiscard]] static std::size_t sizeFor(std::size_t count, float factor);
+
+        void startMigration(std::size_t newSize);
+        void migrate();
+        template<typename Moves>
+        void migrateRange(std::size_t stop, Moves & moved);
+        void finishMigration();
+        std::size_t migrateSlot(std::size_t index);
+
+        [[nodiscard]] std::size_t endIndex() const;
+        [[nodiscard]] Control controlAt(std::size_t index) const;
+        std::pair<Key, Value> & kvAt(std::size_t index);
+        [[nodiscard]] const std::pair<Key, Value> & kvAt(std::size_t index) const;
+        [[nodiscard]] std::size_t nextFull(std::size_t index) const;
+        template<typename F>
+        void visitFull(std::size_t first, std::size_t last, F && fn) const;
+        template<typename Work>
+        void parallelChunks(std::size_t threads, Work && work) const;
+
+        // Hashes go through mix() before they pick a group or a fragment; stored hashes stay as Hash returned them
+        [[nodiscard]] static std::uint64_t mix(HashType hash);
+        template<typename K>
+        [[nodiscard]] bool matches(const Data & data, std::size_t pos, const K & key, HashType hash) const;
+        [[nodiscard]] HashType hashOf(const Data & data, std::size_t pos) const;
+        template<typename K>
+        [[nodiscard]] std::size_t findIn(const Data & data, const K & key, HashType hash) const;
+        template<typename K>
+        [[nodiscard]] std::size_t findIn(const Data & data, const K & key, HashType hash, std::size_t & inspected) const;
+
+        template<typename K>
+        [[nodiscard]] std::size_t findIndex(const K & key, HashType hash) const;
+        template<typename K>
+        [[nodiscard]] std::size_t findIndex(const K & key, HashType hash, std::size_t & inspected) const;
+
+        template<typename K>
+        std::size_t getNextPosition(const K & key, HashType hash);
+
+        void prefetchGroup(HashType hash) const;
+        template<typename F>
+        void lookupMany(std::span<const Key> keys, F && fn) const;
 
-        [[nodiscard]] std::size_t nextCell(HashType hash, std::size_t shift) const;
+        [[nodiscard]] std::size_t findFreeSlot(HashType hash) const;
 
-        [[nodiscard]] std::size_t findIndex(const Key & key) const;
+        template<typename K, typename... Args>
+        std::pair<std::size_t, bool> tryEmplace(K && key, Args &&... args);
+        template<typename K, typename... Args>
+        std::pair<std::size_t, bool> emplaceHashed(HashType hash, K && key, Args &&... args);
 
-        std::size_t getNextPosition(const Key & key, HashType hash);
+        void occupy(std::size_t pos, HashType hash);
+        void eraseAt(std::size_t pos);
 
         [[nodiscard]] std::size_t loadFactor() const;
+        [[nodiscard]] static std::size_t loadFactor(std::size_t size, float factor);
 
         template<typename T>
-        void registerIterator(T * it) const;
+        void registerHandle(T * handle) const;
         template<typename T>
-        void unregisterIterator(T * it) const;
+        void unregisterHandle(T * handle) const;
 
-        void invalidateIterators(flashmap * map = nullptr);
-        void updateIterators();
+        template<typename F>
+        void forEachHandle(F && fn);
+        void markErased(std::size_t pos);
+        void moveHandles(std::size_t from, std::size_t to);
+        void invalidateHandles(flashmap * map = nullptr);
+        void updateHandles();
 
         Data m_Data;
+        Data m_Old;
+        std::size_t m_Migrated;
+        bool m_Incremental;
         Hash m_Hasher;
+        [[no_unique_address]] KeyEqual m_KeyEqual;
         std::size_t m_Count;
+        std::size_t m_Deleted;
+        float m_LoadFactor;
         std::size_t m_MaxLoad;
 
-        mutable std::list<IteratorPtr, container::allocator::chunk_list_allocator<IteratorPtr>> m_ActiveIterators;
-        // mutable std::list<const_iterator*, container::allocator::chunk_list_allocator<const_iterator*>> m_ActiveConstIterators;
-        iterator endIt;
-        const_iterator cendIt;
+        // Bumped whenever elements may move; plain iterators remember it and check it in debug builds
+        std::size_t m_Generation;
+
+        // Lookups are const, so the counters are mutable: a collecting map must not be read from several threads
+        [[no_unique_address]] mutable Stats m_Stats;
+
+        mutable HandleList m_Handles;
 
         friend class Iterator<Value, flashmap>;
         friend class Iterator<const Value, const flashmap>;
+        friend class Handle<Value, flashmap>;
+        friend class Handle<const Value, const flashmap>;
+
+        template<typename K, typename V, typename H, typename E> requires concepts::hashable<K, H>
+        friend class concurrent_flashmap;
     };
 
     #include "flashmapiterator.hpp"
+    #include "flashmaphandle.hpp"
     #include "flashmap.tpp"
+
+    namespace pmr {
+        template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+                 typename Policy = flashmap_policy<>>
+        using flashmap = yulbax::flashmap<Key, Value, Hash, KeyEqual,
+                                          std::pmr::polymorphic_allocator<std::pair<const Key, Value>>, Policy>;
+    }
 }
\ No newline at end of file
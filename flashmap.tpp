@@ -1,270 +1,711 @@
 #pragma once
 
 // PUBLIC METHODS
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-flashmap<Key, Value, Hash>::flashmap(const std::size_t size) : m_Data(std::bit_ceil(size)), m_Hasher(),
-                                                               m_Count(0), m_MaxLoad(loadFactor()),
-                                                               endIt(this, m_Data.size()),
-                                                               cendIt(this, m_Data.size()) {}
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::flashmap(const std::size_t size, const Allocator & alloc)
+    : m_Data(tableSize(size), alloc), m_Old(0, alloc), m_Migrated(0), m_Incremental(false),
+      m_Hasher(), m_KeyEqual(), m_Count(0), m_Deleted(0), m_LoadFactor(LOAD_FACTOR), m_MaxLoad(loadFactor()), m_Generation(0),
+      m_Handles(HandleAlloc(alloc)) {}
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::flashmap(const Allocator & alloc) : flashmap(DEFAULT_SIZE, alloc) {}
+
+// A multi-pass range is counted up front so the table is sized once instead of doubling its way up
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
 template<typename InputIt> requires yulbax::concepts::inititerator<InputIt, Key, Value>
-flashmap<Key, Value, Hash>::flashmap(InputIt first, InputIt last) : flashmap() {
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::flashmap(InputIt first, InputIt last, const Allocator & alloc) : flashmap([&] {
+    if constexpr (std::forward_iterator<InputIt>)
+        return sizeFor(static_cast<std::size_t>(std::ranges::distance(first, last)), LOAD_FACTOR);
+    else
+        return DEFAULT_SIZE;
+}(), alloc) {
     for (; first != last; ++first)
         insert(first->first, first->second);
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-flashmap<Key, Value, Hash>::flashmap(const flashmap & other) : m_Data(other.m_Data), m_Hasher(other.m_Hasher),
-                                                               m_Count(other.m_Count), m_MaxLoad(other.m_MaxLoad),
-                                                               endIt(this, m_Data.size()),
-                                                               cendIt(this, m_Data.size()) {}
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::flashmap(const flashmap & other)
+    : flashmap(other, Traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::flashmap(const flashmap & other, const Allocator & alloc)
+    : m_Data(other.m_Data, alloc), m_Old(other.m_Old, alloc), m_Migrated(other.m_Migrated),
+      m_Incremental(other.m_Incremental), m_Hasher(other.m_Hasher), m_KeyEqual(other.m_KeyEqual), m_Count(other.m_Count),
+      m_Deleted(other.m_Deleted), m_LoadFactor(other.m_LoadFactor), m_MaxLoad(other.m_MaxLoad), m_Generation(0),
+      m_Handles(HandleAlloc(alloc)) {}
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-flashmap<Key, Value, Hash> & flashmap<Key, Value, Hash>::operator=(const flashmap & other) {
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy> & flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::operator=(const flashmap & other) {
     if (this == &other) return *this;
-    invalidateIterators();
+    invalidateHandles();
+    m_Handles.clear();
     m_Data = other.m_Data;
+    m_Old = other.m_Old;
+    m_Migrated = other.m_Migrated;
+    m_Incremental = other.m_Incremental;
     m_Hasher = other.m_Hasher;
+    m_KeyEqual = other.m_KeyEqual;
     m_Count = other.m_Count;
+    m_Deleted = other.m_Deleted;
+    m_LoadFactor = other.m_LoadFactor;
     m_MaxLoad = other.m_MaxLoad;
-    m_ActiveIterators.erase(std::next(m_ActiveIterators.begin(), 2), m_ActiveIterators.end());
-    endIt.m_Index = m_Data.size();
-    cendIt.m_Index = m_Data.size();
+    ++m_Generation;
     return *this;
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-flashmap<Key, Value, Hash>::flashmap(flashmap && other) noexcept
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::flashmap(flashmap && other) noexcept
     : m_Data(std::move(other.m_Data)),
+      m_Old(std::move(other.m_Old)),
+      m_Migrated(other.m_Migrated),
+      m_Incremental(other.m_Incremental),
       m_Hasher(std::move(other.m_Hasher)),
+      m_KeyEqual(std::move(other.m_KeyEqual)),
       m_Count(other.m_Count),
+      m_Deleted(other.m_Deleted),
+      m_LoadFactor(other.m_LoadFactor),
       m_MaxLoad(other.m_MaxLoad),
-      m_ActiveIterators(std::move(other.m_ActiveIterators)),
-      endIt(std::move(other.endIt)),
-      cendIt(std::move(other.cendIt)) {
-    updateIterators();
-    other.m_Data.resize(4);
+      m_Generation(0),
+      m_Handles(std::move(other.m_Handles)) {
+    updateHandles();
+    // The moved list took the pool along; the other map gets a pool of its own so that the two share no state
+    other.m_Handles = HandleList(HandleAlloc(other.get_allocator()));
+    other.m_Data = Data(MIN_SIZE, other.get_allocator());
+    other.m_Old = Data(0, other.get_allocator());
+    other.m_Migrated = 0;
     other.m_Count = 0;
-    other.m_MaxLoad = 3;
-    other.endIt.m_Index = 4;
-    other.cendIt.m_Index = 4;
+    other.m_Deleted = 0;
+    other.m_MaxLoad = other.loadFactor();
+    ++other.m_Generation;
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-flashmap<Key, Value, Hash> & flashmap<Key, Value, Hash>::operator=(flashmap && other) noexcept {
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy> & flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::operator=(flashmap && other)
+    noexcept(Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value) {
     if (this == &other) return *this;
-    invalidateIterators();
+    invalidateHandles();
     m_Data = std::move(other.m_Data);
+    m_Old = std::move(other.m_Old);
+    m_Migrated = other.m_Migrated;
+    m_Incremental = other.m_Incremental;
     m_Hasher = std::move(other.m_Hasher);
+    m_KeyEqual = std::move(other.m_KeyEqual);
     m_Count = other.m_Count;
+    m_Deleted = other.m_Deleted;
+    m_LoadFactor = other.m_LoadFactor;
     m_MaxLoad = other.m_MaxLoad;
-    m_ActiveIterators = std::move(other.m_ActiveIterators);
-    endIt = std::move(other.endIt);
-    cendIt = std::move(other.cendIt);
-    updateIterators();
-    other.m_Data.resize(4);
+    if constexpr (std::allocator_traits<HandleAlloc>::propagate_on_container_move_assignment::value) {
+        m_Handles = std::move(other.m_Handles);
+        other.m_Handles = HandleList(HandleAlloc(other.get_allocator()));
+    } else {
+        // The nodes are rebuilt in this map's pool: the other pool draws on a resource that may not outlive the other map
+        m_Handles.clear();
+        for (const auto & ptr : other.m_Handles) std::visit([&](auto * handle) { registerHandle(handle); }, ptr);
+        other.m_Handles.clear();
+    }
+    updateHandles();
+    ++m_Generation;
+    other.m_Data = Data(MIN_SIZE, other.get_allocator());
+    other.m_Old = Data(0, other.get_allocator());
+    other.m_Migrated = 0;
     other.m_Count = 0;
-    other.m_MaxLoad = 3;
-    other.endIt.m_Index = 4;
-    other.cendIt.m_Index = 4;
+    other.m_Deleted = 0;
+    other.m_MaxLoad = other.loadFactor();
+    ++other.m_Generation;
     return *this;
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-flashmap<Key, Value, Hash>::~flashmap() {
-    invalidateIterators();
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::~flashmap() {
+    invalidateHandles();
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+Allocator flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::get_allocator() const {
+    return m_Data.get_allocator();
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
 template<typename K, typename V>
-bool flashmap<Key, Value, Hash>::insert(K && key, V && value) {
-    if (m_Count > m_MaxLoad) rehash();
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::insert(K && key, V && value) {
+    return tryEmplace(std::forward<K>(key), std::forward<V>(value)).second;
+}
 
-    const HashType newhash = m_Hasher(key);
-    std::size_t pos = getNextPosition(key, newhash);
-    auto [kv, status, hash] = m_Data[pos];
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires concepts::hashable<Key, Hash>
+template<typename K, typename V>
+std::pair<typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::iterator, bool> flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::emplace(K && key, V && value)  {
+    auto [pos, inserted] = tryEmplace(std::forward<K>(key), std::forward<V>(value));
+    return {iterator(this, pos), inserted};
+}
 
-    if (status == Status::OCCUPIED) return false;
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename... KeyArgs, typename... ValueArgs>
+std::pair<typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::iterator, bool>
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::emplace(std::piecewise_construct_t, std::tuple<KeyArgs...> keyArgs, std::tuple<ValueArgs...> valueArgs) {
+    // The key has to exist before it can be hashed: reuse it if it was passed whole, build it once otherwise
+    auto emplaceWith = [&](auto && key) {
+        return std::apply([&](auto &&... args) {
+            return tryEmplace(std::forward<decltype(key)>(key), std::forward<decltype(args)>(args)...);
+        }, std::move(valueArgs));
+    };
 
-    ++m_Count;
-    kv.first = std::forward<K>(key);
-    kv.second = std::forward<V>(value);
-    status = Status::OCCUPIED;
-    hash = newhash;
+    std::pair<std::size_t, bool> result;
+    if constexpr (sizeof...(KeyArgs) == 1 && (std::same_as<std::remove_cvref_t<KeyArgs>, Key> && ...))
+        result = emplaceWith(std::get<0>(std::move(keyArgs)));
+    else
+        result = emplaceWith(std::make_from_tuple<Key>(std::move(keyArgs)));
 
-    return true;
+    return {iterator(this, result.first), result.second};
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K, typename... Args>
+std::pair<typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::iterator, bool> flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::try_emplace(K && key, Args &&... args) {
+    auto [pos, inserted] = tryEmplace(std::forward<K>(key), std::forward<Args>(args)...);
+    return {iterator(this, pos), inserted};
 }
 
-template<typename Key, typename Value, typename Hash> requires concepts::hashable<Key, Hash>
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
 template<typename K, typename V>
-std::pair<typename flashmap<Key, Value, Hash>::iterator, bool> flashmap<Key, Value, Hash>::emplace(K && key, V && value)  {
-    if (m_Count > m_MaxLoad) rehash();
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::insert_with_hash(K && key, V && value, const HashType hash) {
+    return emplaceHashed(hash, std::forward<K>(key), std::forward<V>(value)).second;
+}
 
-    const HashType newhash = m_Hasher(key);
-    std::size_t pos = getNextPosition(key, newhash);
-    auto [kv, status, hash] = m_Data[pos];
+// Hashes and prefetches the home groups of a whole batch before inserting any of it. A key that is not a Key already is
+// converted once and the copy is both hashed and inserted. Should an insertion replace the table, by growing it or by
+// starting a migration, the rest of the batch is prefetched again in the new one.
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename Range> requires std::ranges::forward_range<Range>
+                               && yulbax::concepts::inititerator<std::ranges::iterator_t<Range>, Key, Value>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::insert_range(Range && range) {
+    using K = std::remove_cvref_t<decltype(std::declval<std::ranges::iterator_t<Range> &>()->first)>;
+    constexpr bool CONVERT = !yulbax::concepts::lookupkey<K, Key, Hash, KeyEqual>;
 
-    if (status == Status::OCCUPIED) return {iterator(this, pos), false};
+    std::array<HashType, PREFETCH_BATCH> hashes;
+    std::array<std::optional<Key>, CONVERT ? PREFETCH_BATCH : 0> keys;
+    std::size_t inserted = 0;
 
-    ++m_Count;
-    kv.first = std::forward<K>(key);
-    kv.second = std::forward<V>(value);
-    status = Status::OCCUPIED;
-    hash = newhash;
+    auto it = std::ranges::begin(range);
+    const auto last = std::ranges::end(range);
+    while (it != last) {
+        std::size_t count = 0;
+        for (auto ahead = it; count < PREFETCH_BATCH && ahead != last; ++count, ++ahead) {
+            if constexpr (CONVERT) hashes[count] = m_Hasher(keys[count].emplace(ahead->first));
+            else hashes[count] = m_Hasher(ahead->first);
+            prefetchGroup(hashes[count]);
+        }
 
-    return {iterator(this, pos), true};
+        const Control * table = m_Data.controls.data();
+        for (std::size_t i = 0; i < count; ++i, ++it) {
+            if constexpr (CONVERT) inserted += emplaceHashed(hashes[i], std::move(*keys[i]), it->second).second;
+            else inserted += emplaceHashed(hashes[i], it->first, it->second).second;
+
+            if (m_Data.controls.data() != table) {
+                table = m_Data.controls.data();
+                for (std::size_t ahead = i + 1; ahead < count; ++ahead) prefetchGroup(hashes[ahead]);
+            }
+        }
+    }
+
+    return inserted;
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
 template<typename K>
-Value & flashmap<Key, Value, Hash>::operator[](K && key) {
-    if (m_Count > m_MaxLoad) rehash();
-
-    const HashType newhash = m_Hasher(key);
-    std::size_t pos = getNextPosition(key, newhash);
-    auto [kv, status, hash] = m_Data[pos];
-    if (status != Status::OCCUPIED) {
-        kv.first = std::forward<K>(key);
-        status = Status::OCCUPIED;
-        hash = newhash;
-        ++m_Count;
-    }
+Value & flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::operator[](K && key) {
+    return kvAt(tryEmplace(std::forward<K>(key)).first).second;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+Value & flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::at(const Key & key) {
+    std::size_t pos = findIndex(key, m_Hasher(key));
+    if (pos == endIndex()) throw std::out_of_range("Key not found");
+    return kvAt(pos).second;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+const Value & flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::at(const Key & key) const {
+    std::size_t pos = findIndex(key, m_Hasher(key));
+    if (pos == endIndex()) throw std::out_of_range("Key not found");
+    return kvAt(pos).second;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K> requires yulbax::concepts::transparentkey<K, Key, Hash, KeyEqual>
+Value & flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::at(const K & key) {
+    std::size_t pos = findIndex(key, m_Hasher(key));
+    if (pos == endIndex()) throw std::out_of_range("Key not found");
+    return kvAt(pos).second;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K> requires yulbax::concepts::transparentkey<K, Key, Hash, KeyEqual>
+const Value & flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::at(const K & key) const {
+    std::size_t pos = findIndex(key, m_Hasher(key));
+    if (pos == endIndex()) throw std::out_of_range("Key not found");
+    return kvAt(pos).second;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::contains(const Key & key) const {
+    return findIndex(key, m_Hasher(key)) != endIndex();
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K> requires yulbax::concepts::transparentkey<K, Key, Hash, KeyEqual>
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::contains(const K & key) const {
+    return findIndex(key, m_Hasher(key)) != endIndex();
+}
 
-    return kv.second;
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K> requires yulbax::concepts::lookupkey<K, Key, Hash, KeyEqual>
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::contains(const K & key, const HashType hash) const {
+    return findIndex(key, hash) != endIndex();
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-Value & flashmap<Key, Value, Hash>::at(const Key & key) {
-    std::size_t pos = findIndex(key);
-    if (pos == m_Data.size()) throw std::out_of_range("Key not found");
-    return m_Data.KVs[pos].second;
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::find_many(const std::span<const Key> keys, const std::span<Value *> out) {
+    if (out.size() < keys.size()) throw std::invalid_argument("Output span is shorter than keys");
+    lookupMany(keys, [&](const std::size_t i, const std::size_t pos) {
+        out[i] = pos == endIndex() ? nullptr : &kvAt(pos).second;
+    });
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-const Value & flashmap<Key, Value, Hash>::at(const Key & key) const {
-    std::size_t pos = findIndex(key);
-    if (pos == m_Data.size()) throw std::out_of_range("Key not found");
-    return m_Data.KVs[pos].second;
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::find_many(const std::span<const Key> keys, const std::span<const Value *> out) const {
+    if (out.size() < keys.size()) throw std::invalid_argument("Output span is shorter than keys");
+    lookupMany(keys, [&](const std::size_t i, const std::size_t pos) {
+        out[i] = pos == endIndex() ? nullptr : &kvAt(pos).second;
+    });
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-bool flashmap<Key, Value, Hash>::contains(const Key & key) const {
-    return findIndex(key) != m_Data.size();
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::contains_many(const std::span<const Key> keys, const std::span<bool> out) const {
+    if (out.size() < keys.size()) throw std::invalid_argument("Output span is shorter than keys");
+    lookupMany(keys, [&](const std::size_t i, const std::size_t pos) {
+        out[i] = pos != endIndex();
+    });
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-std::size_t flashmap<Key, Value, Hash>::size() const {
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::size() const {
     return m_Count;
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-bool flashmap<Key, Value, Hash>::erase(const Key & key) {
-    std::size_t pos = findIndex(key);
-    if (pos != m_Data.size()) {
-        m_Data.statuses[pos] = Status::DELETED;
-        --m_Count;
-        return true;
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::bucket_count() const {
+    return m_Data.size();
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+float flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::load_factor() const {
+    return static_cast<float>(m_Count) / static_cast<float>(m_Data.size());
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+float flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::max_load_factor() const {
+    return m_LoadFactor;
+}
+
+// Takes effect at once: a table already past the new limit is rebuilt to fit it
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::max_load_factor(const float factor) {
+    if (!(factor > 0.0f && factor <= 1.0f)) throw std::invalid_argument("Max load factor must be in (0, 1]");
+    m_LoadFactor = factor;
+    m_MaxLoad = loadFactor();
+    if (m_Count + m_Deleted > m_MaxLoad) rehash(0);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::reserve(const std::size_t count) {
+    if (sizeFor(count, m_LoadFactor) > m_Data.size()) rehash(sizeFor(count, m_LoadFactor));
+}
+
+// Always a full rebuild, also when incremental rehashing is on: the caller asked for the work to happen now
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::rehash(const std::size_t buckets) {
+    if (m_Old.size()) finishMigration();
+    resize(std::max(tableSize(buckets), sizeFor(m_Count, m_LoadFactor)));
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::shrink_to_fit() {
+    if (m_Old.size()) finishMigration();
+    if (sizeFor(m_Count, m_LoadFactor) < m_Data.size()) resize(sizeFor(m_Count, m_LoadFactor));
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::probe_length(const Key & key) const {
+    std::size_t probes;
+    static_cast<void>(findIndex(key, m_Hasher(key), probes));
+    return probes;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap_stats flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::stats() const {
+    static constexpr std::size_t HANDLE_BYTES = sizeof(HandlePtr) + 2 * sizeof(void *);
+
+    flashmap_stats stats;
+    stats.size = m_Count;
+    stats.bucket_count = m_Data.size();
+    stats.load_factor = load_factor();
+    stats.tombstones = m_Deleted;
+    stats.tombstone_ratio = static_cast<float>(m_Deleted) / static_cast<float>(m_Data.size());
+    stats.migrating = m_Old.size() != 0;
+    stats.handles = m_Handles.size();
+    stats.memory_bytes = sizeof(*this) + (m_Data.size() + m_Old.size()) * Data::SLOT_BYTES + m_Handles.size() * HANDLE_BYTES;
+    m_Stats.fill(stats);
+    return stats;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::reset_stats() {
+    m_Stats.reset();
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::dump_layout(std::ostream & out) const {
+    out << "flashmap: " << m_Count << " elements, " << m_Data.size() << " slots in groups of " << Group::WIDTH
+        << ", load " << load_factor() << '\n';
+    out << "current table\n";
+    container::flashmap::impl::dumpLayout(out, m_Data.controls.data(), m_Data.size());
+    if (m_Old.size()) {
+        out << "old table, " << m_Migrated << " of " << m_Old.size() << " slots migrated\n";
+        container::flashmap::impl::dumpLayout(out, m_Old.controls.data(), m_Old.size());
     }
-    return false;
 }
 
-template<typename Key, typename Value, typename Hash> requires concepts::hashable<Key, Hash>
-bool flashmap<Key, Value, Hash>::erase(iterator & it)  {
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::erase(const Key & key) {
+    std::size_t pos = findIndex(key, m_Hasher(key));
+    if (pos == endIndex()) return false;
+    eraseAt(pos);
+    return true;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K> requires yulbax::concepts::transparentkey<K, Key, Hash, KeyEqual>
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::erase(const K & key) {
+    std::size_t pos = findIndex(key, m_Hasher(key));
+    if (pos == endIndex()) return false;
+    eraseAt(pos);
+    return true;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires concepts::hashable<Key, Hash>
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::erase(iterator & it)  {
     if (it.m_Map != this) return false;
 
     std::size_t pos = it.m_Index;
-    if (pos >= m_Data.size() || m_Data.statuses[pos] == Status::DELETED) return false;
-    m_Data.statuses[pos] = Status::DELETED;
-    --m_Count;
+    it.checkGeneration();
+    if (pos >= endIndex() || it.m_Erased || !isFull(controlAt(pos))) return false;
+    eraseAt(pos);
+
+    // The iterator stays usable for ++: it revisits its slot in case backward shift refilled it
+    it.m_Erased = true;
+    it.m_Generation = m_Generation;
+    return true;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires concepts::hashable<Key, Hash>
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::erase(stable_handle & handle)  {
+    if (handle.m_Map != this || !handle.valid()) return false;
+    eraseAt(handle.m_Index);
     return true;
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-void flashmap<Key, Value, Hash>::clear() {
-    std::ranges::fill(m_Data.statuses, Status::FREE);
-    invalidateIterators();
-    m_ActiveIterators.erase(std::next(m_ActiveIterators.begin(), 2), m_ActiveIterators.end());
-    endIt.m_Map = this; cendIt.m_Map = this;
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::clear() {
+    m_Data.clear();
+    m_Old = Data(0, get_allocator());
+    m_Migrated = 0;
+    forEachHandle([](auto * handle) { handle->m_Erased = true; });
+    ++m_Generation;
     m_Count = 0;
+    m_Deleted = 0;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::incremental_rehash(const bool enabled) {
+    if (!enabled && m_Old.size()) finishMigration();
+    m_Incremental = enabled;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::incremental_rehash() const {
+    return m_Incremental;
+}
+
+// Empty slots are written as zeros rather than whatever an erased pair left behind
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::save(const std::filesystem::path & path) const
+    requires std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value> {
+    // A snapshot holds a single table: finish a migration in flight on a copy instead of on this map
+    if (m_Old.size()) {
+        flashmap copy(*this);
+        copy.incremental_rehash(false);
+        copy.save(path);
+        return;
+    }
+
+    using Header = container::flashmap::impl::SnapshotHeader;
+    using Slot   = typename Data::Entry;
+    const Header header = Header::template make<Data, Probing>(m_Data.size(), m_Count, m_Deleted);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Cannot open snapshot for writing: " + path.string());
+
+    std::uint64_t written = 0;
+    const auto write = [&](const void * data, const std::size_t bytes) {
+        out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        written += bytes;
+    };
+    const auto padTo = [&](const std::uint64_t offset) {
+        static constexpr char zeros[Header::ALIGNMENT] = {};
+        write(zeros, offset - written);
+    };
+
+    write(&header, sizeof(header));
+    padTo(header.controlsOffset);
+    write(m_Data.controls.data(), m_Data.size() * sizeof(Control));
+    padTo(header.hashesOffset);
+    if constexpr (Data::SPLIT_HASHES) write(m_Data.hashes.data(), m_Data.size() * sizeof(HashType));
+    padTo(header.slotsOffset);
+
+    static constexpr std::size_t BATCH = 1024;
+    std::vector<std::byte> buffer(BATCH * sizeof(Slot));
+    for (std::size_t first = 0; first < m_Data.size(); first += BATCH) {
+        const std::size_t count = std::min(BATCH, m_Data.size() - first);
+        std::ranges::fill(buffer, std::byte{0});
+        for (std::size_t i = 0; i < count; ++i) {
+            if (isFull(m_Data.controls[first + i])) std::memcpy(&buffer[i * sizeof(Slot)], &m_Data.slots[first + i], sizeof(Slot));
+        }
+        write(buffer.data(), count * sizeof(Slot));
+    }
+
+    out.flush();
+    if (!out) throw std::runtime_error("Failed to write snapshot: " + path.string());
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-typename flashmap<Key, Value, Hash>::iterator
-flashmap<Key, Value, Hash>::begin() {
+// The arrays are read straight into a table of the saved size; a snapshot from a build with another group width or
+// probing policy has a different probe order and is reinserted instead
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy> flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::load(const std::filesystem::path & path, const Allocator & alloc)
+    requires std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value> {
+    using Header = container::flashmap::impl::SnapshotHeader;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open snapshot: " + path.string());
+
+    Header header;
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header))) throw std::runtime_error("Snapshot is corrupt");
+    const bool sameProbes = header.template validate<Data, Probing>(std::filesystem::file_size(path));
+
+    Data data(header.slots, alloc);
+    const auto read = [&](const std::uint64_t offset, void * target, const std::size_t bytes) {
+        in.seekg(static_cast<std::streamoff>(offset));
+        if (!in.read(static_cast<char *>(target), static_cast<std::streamsize>(bytes))) {
+            throw std::runtime_error("Snapshot is corrupt");
+        }
+    };
+    read(header.controlsOffset, data.controls.data(), data.size() * sizeof(Control));
+    if constexpr (Data::SPLIT_HASHES) read(header.hashesOffset, data.hashes.data(), data.size() * sizeof(HashType));
+    read(header.slotsOffset, data.slots.data(), data.size() * sizeof(typename Data::Entry));
+
+    flashmap map(alloc);
+    if (!sameProbes) {
+        map.reserve(header.count);
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (isFull(data.controls[i])) map.insert(data.kv(i).first, data.kv(i).second);
+        }
+        data.clear();
+        return map;
+    }
+
+    map.m_Data = std::move(data);
+    map.m_Count = header.count;
+    map.m_Deleted = header.deleted;
+    map.m_MaxLoad = map.loadFactor();
+
+    // The table is trusted from here on, so make sure this build's hasher finds a sample of the elements where they are
+    static constexpr std::size_t SAMPLE = 16;
+    for (std::size_t i = 0, checked = 0; i < map.m_Data.size() && checked < SAMPLE; ++i) {
+        if (!isFull(map.m_Data.controls[i])) continue;
+        const Key & key = map.m_Data.kv(i).first;
+        if (map.findIn(map.m_Data, key, map.m_Hasher(key)) != i) {
+            throw std::runtime_error("Snapshot was written with a different hash function");
+        }
+        ++checked;
+    }
+    return map;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::iterator
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::begin() {
     if (!m_Count) return end();
-    auto pos = std::ranges::find(m_Data.statuses, Status::OCCUPIED);
-    std::size_t index = pos - m_Data.statuses.begin();
-    return iterator(this, index);
+    return iterator(this, nextFull(0));
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-typename flashmap<Key, Value, Hash>::const_iterator
-flashmap<Key, Value, Hash>::begin() const {
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::const_iterator
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::begin() const {
     if (!m_Count) return end();
-    auto pos = std::ranges::find(m_Data.statuses, Status::OCCUPIED);
-    std::size_t index = pos - m_Data.statuses.begin();
-    return const_iterator(this, index);
+    return const_iterator(this, nextFull(0));
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::iterator
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::end() {
+    return iterator(this, endIndex());
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::const_iterator
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::end() const {
+    return const_iterator(this, endIndex());
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-typename flashmap<Key, Value, Hash>::iterator &
-flashmap<Key, Value, Hash>::end() {
-    return endIt;
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename F>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::parallel_for_each(F && fn, const std::size_t threads) {
+    parallelChunks(threads, [&](const std::size_t first, const std::size_t last) {
+        visitFull(first, last, [&](const std::size_t index) {
+            fn(*std::launder(reinterpret_cast<value_type *>(&kvAt(index))));
+        });
+    });
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-const typename flashmap<Key, Value, Hash>::const_iterator &
-flashmap<Key, Value, Hash>::end() const {
-    return cendIt;
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename F>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::parallel_for_each(F && fn, const std::size_t threads) const {
+    parallelChunks(threads, [&](const std::size_t first, const std::size_t last) {
+        visitFull(first, last, [&](const std::size_t index) {
+            fn(*std::launder(reinterpret_cast<const value_type *>(&kvAt(index))));
+        });
+    });
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-typename flashmap<Key, Value, Hash>::iterator
-flashmap<Key, Value, Hash>::find(const Key & key) {
-    const std::size_t pos = findIndex(key);
-    if (pos == m_Data.size()) return end();
+// One partial result per chunk, combined in slot order at the end: the result does not depend on which worker took
+// which chunk, not even for floating-point sums
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename T, typename Reduce, typename Transform>
+T flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::parallel_reduce(T init, Reduce && reduce, Transform && transform, const std::size_t threads) const {
+    std::vector<std::optional<T>> partials((endIndex() + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK);
+    parallelChunks(threads, [&](const std::size_t first, const std::size_t last) {
+        std::optional<T> & partial = partials[first / PARALLEL_CHUNK];
+        visitFull(first, last, [&](const std::size_t index) {
+            const auto & element = *std::launder(reinterpret_cast<const value_type *>(&kvAt(index)));
+            if (partial) partial = reduce(std::move(*partial), transform(element));
+            else partial.emplace(transform(element));
+        });
+    });
+
+    for (std::optional<T> & partial : partials) {
+        if (partial) init = reduce(std::move(init), std::move(*partial));
+    }
+    return init;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::iterator
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::find(const Key & key) {
+    const std::size_t pos = findIndex(key, m_Hasher(key));
+    if (pos == endIndex()) return end();
     return iterator(this, pos);
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-typename flashmap<Key, Value, Hash>::const_iterator
-flashmap<Key, Value, Hash>::find(const Key & key) const {
-    const std::size_t pos = findIndex(key);
-    if (pos == m_Data.size()) return end();
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::const_iterator
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::find(const Key & key) const {
+    const std::size_t pos = findIndex(key, m_Hasher(key));
+    if (pos == endIndex()) return end();
     return const_iterator(this, pos);
 }
 
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K> requires yulbax::concepts::transparentkey<K, Key, Hash, KeyEqual>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::iterator
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::find(const K & key) {
+    return find(key, m_Hasher(key));
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K> requires yulbax::concepts::transparentkey<K, Key, Hash, KeyEqual>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::const_iterator
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::find(const K & key) const {
+    return find(key, m_Hasher(key));
+}
+
+// The hash must be the one hash_function() gives for key; it is trusted, not recomputed
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K> requires yulbax::concepts::lookupkey<K, Key, Hash, KeyEqual>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::iterator
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::find(const K & key, const HashType hash) {
+    const std::size_t pos = findIndex(key, hash);
+    if (pos == endIndex()) return end();
+    return iterator(this, pos);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K> requires yulbax::concepts::lookupkey<K, Key, Hash, KeyEqual>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::const_iterator
+flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::find(const K & key, const HashType hash) const {
+    const std::size_t pos = findIndex(key, hash);
+    if (pos == endIndex()) return end();
+    return const_iterator(this, pos);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+Hash flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::hash_function() const {
+    return m_Hasher;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+KeyEqual flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::key_eq() const {
+    return m_KeyEqual;
+}
+
 // PRIVATE METHODS
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-void flashmap<Key, Value, Hash>::rehash() {
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::grow() {
+    if (m_Old.size()) finishMigration();
+
+    // Mostly tombstones: rebuild at the same size instead of doubling
+    const std::size_t newSize = m_Count > m_MaxLoad / 2 ? m_Data.size() * 2 : m_Data.size();
+    if (m_Incremental) startMigration(newSize);
+    else resize(newSize);
+}
+
+// Stop-the-world rebuild into a table of newSize slots; expects no migration in flight
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::resize(const std::size_t newSize) {
+    const auto started = m_Stats.start();
+    m_Stats.rehashStarted();
+    ++m_Generation;
+
     Data oldData = std::move(m_Data);
-    std::size_t newSize = oldData.size() * 2;
-    m_Data.resize(newSize);
-    m_MaxLoad *= 2;
-    auto iterStart = std::next(m_ActiveIterators.begin(), 2);
-    endIt.m_Index = newSize; cendIt.m_Index = newSize;
+    m_Data = Data(newSize, get_allocator());
+    m_MaxLoad = loadFactor();
+    m_Deleted = 0;
 
-    if (m_ActiveIterators.size() > 2) {
-        flashmap<std::size_t, std::size_t> updatedPositions(m_ActiveIterators.size());
+    if (!m_Handles.empty()) {
+        flashmap<std::size_t, std::size_t> updatedPositions(m_Handles.size());
 
-        for (auto & ptr : std::ranges::subrange(iterStart, m_ActiveIterators.end())) {
+        for (auto & ptr : m_Handles) {
             std::visit([&](auto * it) {
+                if (it->m_Erased || it->m_Index >= oldData.size()) return;
                 if (updatedPositions.contains(it->m_Index)) {
                     it->m_Index = updatedPositions.at(it->m_Index);
                     return;
                 }
 
-                auto [oldKV, oldStatus, oldHash] = oldData[it->m_Index];
-                if (oldStatus != Status::OCCUPIED) return;
-
-                std::size_t newPos = getNextPosition(oldKV.first, oldHash);
-                auto [newKV, newStatus, newHash] = m_Data[newPos];
+                if (!isFull(oldData.controls[it->m_Index])) return;
 
-                newKV = std::move(oldKV);
-                newStatus = Status::OCCUPIED;
-                newHash = oldHash;
-                oldStatus = Status::DELETED;
+                const std::size_t newPos = findFreeSlot(hashOf(oldData, it->m_Index));
+                m_Data.transfer(newPos, oldData, it->m_Index);
+                m_Data.controls[newPos] = oldData.controls[it->m_Index];
+                oldData.controls[it->m_Index] = Control::DELETED;
 
                 updatedPositions[it->m_Index] = newPos;
                 it->m_Index = newPos;
@@ -273,98 +714,492 @@ void flashmap<Key, Value, Hash>::rehash() {
     }
 
     for (size_t i = 0; i < oldData.size(); ++i) {
-        auto [oldKV, oldStatus, oldHash] = oldData[i];
-        if (oldStatus != Status::OCCUPIED) continue;
-        std::size_t newPos = getNextPosition(oldKV.first, oldHash);
-        auto [newKV, newStatus, newHash] = m_Data[newPos];
-        newKV = std::move(oldKV);
-        newStatus = Status::OCCUPIED;
-        newHash = oldHash;
+        if (!isFull(oldData.controls[i])) continue;
+        const std::size_t newPos = findFreeSlot(hashOf(oldData, i));
+        m_Data.transfer(newPos, oldData, i);
+        m_Data.controls[newPos] = oldData.controls[i];
+        oldData.controls[i] = Control::DELETED;
+    }
+
+    m_Stats.moved(started, m_Count, m_Count * MOVED_BYTES);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::startMigration(const std::size_t newSize) {
+    m_Stats.rehashStarted();
+    m_Old = std::move(m_Data);
+    m_Data = Data(newSize, get_allocator());
+    m_Migrated = 0;
+    m_MaxLoad = loadFactor();
+    m_Deleted = 0;
+    ++m_Generation;
+
+    // Until migration completes, indices past the new table address the old one
+    forEachHandle([&](auto * handle) { handle->m_Index += newSize; });
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::migrate() {
+    std::array<std::size_t, MIGRATE_SLOTS> moved;
+    migrateRange(std::min(m_Migrated + MIGRATE_SLOTS, m_Old.size()), moved);
+    if (m_Migrated == m_Old.size()) finishMigration();
+}
+
+// Moves the full slots of m_Old in [m_Migrated, stop) into m_Data. The vacated slots become DELETED rather than FREE
+// so that lookups of elements still waiting further down an old probe chain keep working.
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename Moves>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::migrateRange(const std::size_t stop, Moves & moved) {
+    const auto started = m_Stats.start();
+    const bool tracked = !m_Handles.empty();
+    std::size_t elements = 0;
+    for (std::size_t i = m_Migrated; i < stop; ++i) {
+        if (!isFull(m_Old.controls[i])) continue;
+        const std::size_t pos = migrateSlot(i);
+        if (tracked) moved[i - m_Migrated] = pos;
+        ++elements;
+    }
+
+    if (tracked) {
+        const std::size_t first = m_Data.size() + m_Migrated;
+        const std::size_t last = m_Data.size() + stop;
+        forEachHandle([&](auto * handle) {
+            if (!handle->m_Erased && handle->m_Index >= first && handle->m_Index < last) {
+                handle->m_Index = moved[handle->m_Index - first];
+            }
+        });
+    }
+
+    m_Migrated = stop;
+    ++m_Generation;
+    m_Stats.moved(started, elements, elements * MOVED_BYTES);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::finishMigration() {
+    if (m_Migrated < m_Old.size()) {
+        std::vector<std::size_t> moved(m_Handles.empty() ? 0 : m_Old.size() - m_Migrated);
+        migrateRange(m_Old.size(), moved);
     }
+
+    // Only handles on erased elements can still point past the new table
+    forEachHandle([&](auto * handle) { handle->m_Index = std::min(handle->m_Index, m_Data.size()); });
+    m_Old = Data(0, get_allocator());
+    m_Migrated = 0;
+    ++m_Generation;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::migrateSlot(const std::size_t index) {
+    const std::size_t pos = findFreeSlot(hashOf(m_Old, index));
+
+    if (m_Data.controls[pos] == Control::DELETED) --m_Deleted;
+    m_Data.transfer(pos, m_Old, index);
+    m_Data.controls[pos] = m_Old.controls[index];
+    m_Old.controls[index] = Control::DELETED;
+    return pos;
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-std::size_t flashmap<Key, Value, Hash>::nextCell(const HashType hash, const std::size_t shift) const {
-    return (hash + shift) & (m_Data.size() - 1);
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::endIndex() const {
+    return m_Data.size() + m_Old.size();
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-std::size_t flashmap<Key, Value, Hash>::findIndex(const Key & key) const {
-    const HashType hash = m_Hasher(key);
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::Control flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::controlAt(const std::size_t index) const {
+    return index < m_Data.size() ? m_Data.controls[index] : m_Old.controls[index - m_Data.size()];
+}
 
-    for (std::size_t shift = 0; ; ++shift) {
-        std::size_t pos = nextCell(hash, shift);
-        auto [kv, status, currentHash] = m_Data[pos];
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::pair<Key, Value> & flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::kvAt(const std::size_t index) {
+    return index < m_Data.size() ? m_Data.kv(index) : m_Old.kv(index - m_Data.size());
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+const std::pair<Key, Value> & flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::kvAt(const std::size_t index) const {
+    return index < m_Data.size() ? m_Data.kv(index) : m_Old.kv(index - m_Data.size());
+}
+
+// First full slot at or after index in the combined index space of both tables, or endIndex()
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::nextFull(const std::size_t index) const {
+    if (index < m_Data.size()) {
+        const std::size_t pos = container::flashmap::impl::nextFull(m_Data.controls.data(), index, m_Data.size());
+        if (pos != m_Data.size() || !m_Old.size()) return pos;
+    }
+    const std::size_t old = index > m_Data.size() ? index - m_Data.size() : 0;
+    return m_Data.size() + container::flashmap::impl::nextFull(m_Old.controls.data(), old, m_Old.size());
+}
+
+// Calls fn(index) for every full slot in [first, last) of the combined index space. Both bounds are multiples of the
+// group width, and so are the table sizes, so no group straddles the two tables.
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename F>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::visitFull(std::size_t first, const std::size_t last, F && fn) const {
+    for (; first < last; first += Group::WIDTH) {
+        const Control * controls = first < m_Data.size() ? &m_Data.controls[first] : &m_Old.controls[first - m_Data.size()];
+        for (const unsigned i : Group(controls).matchFull()) fn(first + i);
+    }
+}
 
-        if (status == Status::FREE) break;
+// Workers claim chunks of PARALLEL_CHUNK slots from a shared counter, so one that draws dense or expensive chunks does
+// not hold the others up; the calling thread is one of them. An exception stops further claims.
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename Work>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::parallelChunks(const std::size_t threads, Work && work) const {
+    const std::size_t slots = endIndex();
+    const std::size_t chunks = (slots + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+    const std::size_t wanted = threads ? threads : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    const std::size_t workers = std::min(wanted, chunks);
 
-        if (status == Status::OCCUPIED && currentHash == hash) {
-#ifdef CHECK_KEY_EQUALITY
-            if (key == kv.first)
-#endif
-            return pos;
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    const auto run = [&] {
+        try {
+            for (std::size_t chunk = next++; chunk < chunks; chunk = next++) {
+                const std::size_t first = chunk * PARALLEL_CHUNK;
+                work(first, std::min(first + PARALLEL_CHUNK, slots));
+            }
+        } catch (...) {
+            next = chunks;
+            std::lock_guard lock(errorMutex);
+            if (!error) error = std::current_exception();
         }
+    };
+
+    {
+        std::vector<std::jthread> pool;
+        pool.reserve(workers - 1);
+        for (std::size_t i = 1; i < workers; ++i) pool.emplace_back(run);
+        run();
     }
+    if (error) std::rethrow_exception(error);
+}
 
-    return m_Data.size();
+// The stored hash, where there is one, rules out fragment collisions before the possibly expensive key comparison
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K>
+bool flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::matches(const Data & data, const std::size_t pos, const K & key, const HashType hash) const {
+    if constexpr (Data::STORE_HASH) {
+        if (data.hash(pos) != hash) return false;
+    }
+    return m_KeyEqual(key, data.kv(pos).first);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::HashType flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::hashOf(const Data & data, const std::size_t pos) const {
+    if constexpr (Data::STORE_HASH) return data.hash(pos);
+    else return m_Hasher(data.kv(pos).first);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::uint64_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::mix(const HashType hash) {
+    return container::flashmap::impl::mix<Hash>(hash);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::findIn(const Data & data, const K & key, const HashType hash) const {
+    std::size_t inspected;
+    return findIn(data, key, hash, inspected);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::findIn(const Data & data, const K & key, const HashType hash, std::size_t & inspected) const {
+    return container::flashmap::impl::probe<Probing>(data.controls.data(), data.size(), mix(hash), [&](const std::size_t pos) {
+        return matches(data, pos, key, hash);
+    }, inspected);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::findIndex(const K & key, const HashType hash) const {
+    std::size_t inspected;
+    const std::size_t pos = findIndex(key, hash, inspected);
+    m_Stats.lookup(pos != endIndex(), inspected);
+    return pos;
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-std::size_t flashmap<Key, Value, Hash>::getNextPosition(const Key & key, const HashType hash) {
+// Uncounted; inspected adds up the groups of both tables when the old one had to be searched too
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::findIndex(const K & key, const HashType hash, std::size_t & inspected) const {
+    if (const std::size_t pos = findIn(m_Data, key, hash, inspected); pos != m_Data.size()) return pos;
+
+    if (m_Old.size()) {
+        std::size_t old;
+        const std::size_t pos = findIn(m_Old, key, hash, old);
+        inspected += old;
+        if (pos != m_Old.size()) return m_Data.size() + pos;
+    }
+    return endIndex();
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::getNextPosition(const K & key, const HashType hash) {
+    const std::uint64_t mixed = mix(hash);
+    const std::uint8_t h2 = container::flashmap::impl::fragment(mixed);
+    const std::size_t groups = m_Data.size() / Group::WIDTH;
     std::size_t firstDeleted = m_Data.size();
 
-    for (std::size_t shift = 0; ; ++shift) {
-        std::size_t pos = nextCell(hash, shift);
-        auto [kv, status, currentHash] = m_Data[pos];
+    for (ProbeSeq seq(mixed, m_Data.size() - 1); seq.probes() < groups; seq.next()) {
+        const Group group(&m_Data.controls[seq.offset()]);
 
-        if (currentHash == hash && status == Status::OCCUPIED) {
-#ifdef CHECK_KEY_EQUALITY
-            if (key == kv.first)
-#endif
-            return pos;
+        for (const unsigned i : group.match(h2)) {
+            const std::size_t pos = seq.offset(i);
+            if (matches(m_Data, pos, key, hash)) return pos;
         }
 
-        if (status == Status::DELETED && firstDeleted == m_Data.size()) {
-            firstDeleted = pos;
+        if (firstDeleted == m_Data.size()) {
+            if (const auto deleted = group.matchFreeOrDeleted()) firstDeleted = seq.offset(deleted.lowest());
         }
 
-        if (status == Status::FREE) {
-            return firstDeleted != m_Data.size() ? firstDeleted : pos;
+        if (group.matchFree()) break;
+    }
+
+    if (m_Old.size()) {
+        if (const std::size_t pos = findIn(m_Old, key, hash); pos != m_Old.size()) return m_Data.size() + pos;
+    }
+    return firstDeleted;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::prefetchGroup(const HashType hash) const {
+    container::flashmap::impl::prefetch(&m_Data.controls[ProbeSeq(mix(hash), m_Data.size() - 1).offset()]);
+}
+
+// Three passes per batch so the cache misses of one pass overlap: hash and prefetch the home groups, then match the
+// (now cached) control bytes and prefetch the first candidate slot, then resolve every probe as usual
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename F>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::lookupMany(const std::span<const Key> keys, F && fn) const {
+    std::array<HashType, PREFETCH_BATCH> hashes;
+
+    for (std::size_t first = 0; first < keys.size(); first += PREFETCH_BATCH) {
+        const std::size_t count = std::min(PREFETCH_BATCH, keys.size() - first);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            hashes[i] = m_Hasher(keys[first + i]);
+            prefetchGroup(hashes[i]);
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint64_t mixed = mix(hashes[i]);
+            const ProbeSeq seq(mixed, m_Data.size() - 1);
+            const auto match = Group(&m_Data.controls[seq.offset()]).match(container::flashmap::impl::fragment(mixed));
+            if (!match) continue;
+            const std::size_t candidate = seq.offset(match.lowest());
+            container::flashmap::impl::prefetch(&m_Data.kv(candidate));
+            if constexpr (Data::SPLIT_HASHES) container::flashmap::impl::prefetch(&m_Data.hashes[candidate]);
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(first + i, findIndex(keys[first + i], hashes[i]));
         }
     }
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-std::size_t flashmap<Key, Value, Hash>::loadFactor() const {
-    return m_Data.size() * LOAD_FACTOR;
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::findFreeSlot(const HashType hash) const {
+    for (ProbeSeq seq(mix(hash), m_Data.size() - 1); ; seq.next()) {
+        if (const auto free = Group(&m_Data.controls[seq.offset()]).matchFreeOrDeleted()) {
+            return seq.offset(free.lowest());
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K, typename... Args>
+std::pair<std::size_t, bool> flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::tryEmplace(K && key, Args &&... args) {
+    if constexpr (yulbax::concepts::lookupkey<K, Key, Hash, KeyEqual>) {
+        const HashType hash = m_Hasher(key);
+        return emplaceHashed(hash, std::forward<K>(key), std::forward<Args>(args)...);
+    } else {
+        return tryEmplace(Key(std::forward<K>(key)), std::forward<Args>(args)...);
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename K, typename... Args>
+std::pair<std::size_t, bool> flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::emplaceHashed(const HashType newhash, K && key, Args &&... args) {
+    if constexpr (!yulbax::concepts::lookupkey<K, Key, Hash, KeyEqual>) {
+        return emplaceHashed(newhash, Key(std::forward<K>(key)), std::forward<Args>(args)...);
+    } else {
+        if (m_Old.size()) migrate();
+        if (m_Count + m_Deleted > m_MaxLoad) grow();
+
+        std::size_t pos = getNextPosition(key, newhash);
+
+        if (isFull(controlAt(pos))) return {pos, false};
+
+        m_Data.construct(pos, std::piecewise_construct,
+                         std::forward_as_tuple(std::forward<K>(key)),
+                         std::forward_as_tuple(std::forward<Args>(args)...));
+        occupy(pos, newhash);
+
+        return {pos, true};
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::occupy(const std::size_t pos, const HashType hash) {
+    if (m_Data.controls[pos] == Control::DELETED) --m_Deleted;
+    m_Data.controls[pos] = static_cast<Control>(container::flashmap::impl::fragment(mix(hash)));
+    m_Data.setHash(pos, hash);
+    ++m_Count;
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
+// Backward-shift deletion for group-linear probing: the hole is refilled by the nearest element from a later group
+// whose probe sequence passes through the hole's group, and the element's old slot becomes the next hole. Once no such
+// element exists before the chain ends, the hole can become FREE without cutting any probe sequence short.
+// Triangular probe sequences do not run through neighbouring groups, so there the hole only becomes FREE if its group
+// still has a FREE slot: no probe has ever gone past that group. Otherwise it is left as a tombstone.
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::eraseAt(std::size_t pos) {
+    const std::size_t mask = m_Data.size() - 1;
+    const std::size_t groupMask = ~(Group::WIDTH - 1);
+    --m_Count;
+    ++m_Generation;
+    markErased(pos);
+
+    // The old table is only drained, never shifted: an element moved behind the migration cursor would be lost
+    if (pos >= m_Data.size()) {
+        m_Old.destroy(pos - m_Data.size());
+        m_Old.controls[pos - m_Data.size()] = Control::DELETED;
+        return;
+    }
+
+    m_Data.destroy(pos);
+
+    for (;;) {
+        const std::size_t holeGroup = pos & groupMask;
+        if (Group(&m_Data.controls[holeGroup]).matchFree()) {
+            m_Data.controls[pos] = Control::FREE;
+            return;
+        }
+
+        if constexpr (Probing::TRIANGULAR) {
+            m_Data.controls[pos] = Control::DELETED;
+            ++m_Deleted;
+            return;
+        }
+
+        std::size_t candidate = m_Data.size();
+        for (std::size_t group = (holeGroup + Group::WIDTH) & mask; group != holeGroup; group = (group + Group::WIDTH) & mask) {
+            const Group current(&m_Data.controls[group]);
+            for (const unsigned i : current.matchFull()) {
+                const std::size_t home = ProbeSeq(mix(hashOf(m_Data, group + i)), mask).offset();
+                if (((holeGroup - home) & mask) < ((group - home) & mask)) {
+                    candidate = group + i;
+                    break;
+                }
+            }
+            if (candidate != m_Data.size() || current.matchFree()) break;
+        }
+
+        if (candidate == m_Data.size()) {
+            m_Data.controls[pos] = Control::FREE;
+            return;
+        }
+
+        // Moving an element back across the end of the table would let forward iteration visit it twice
+        if (candidate < pos) {
+            m_Data.controls[pos] = Control::DELETED;
+            ++m_Deleted;
+            return;
+        }
+
+        m_Data.transfer(pos, m_Data, candidate);
+        m_Data.controls[pos] = m_Data.controls[candidate];
+        moveHandles(candidate, pos);
+        pos = candidate;
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::loadFactor() const {
+    return loadFactor(m_Data.size(), m_LoadFactor);
+}
+
+// Inserts only check the limit before adding, so one slot is kept back for the insert that reaches it
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::loadFactor(const std::size_t size, const float factor) {
+    return std::min(static_cast<std::size_t>(static_cast<double>(size) * factor), size - 1);
+}
+
+// Smallest power of two of at least slots and one group
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::tableSize(const std::size_t slots) {
+    if (slots > MAX_SIZE) throw std::length_error("Requested size exceeds the maximum table size");
+    return std::max(std::bit_ceil(slots), MIN_SIZE);
+}
+
+// Smallest table that holds count elements without growing; the quotient is checked while still a double, since
+// converting one past the range of std::size_t is undefined
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::sizeFor(const std::size_t count, const float factor) {
+    const double slots = static_cast<double>(count) / factor;
+    if (!(slots <= static_cast<double>(MAX_SIZE))) throw std::length_error("Requested size exceeds the maximum table size");
+
+    std::size_t size = tableSize(static_cast<std::size_t>(slots));
+    while (loadFactor(size, factor) < count) {
+        if (size == MAX_SIZE) throw std::length_error("Requested size exceeds the maximum table size");
+        size *= 2;
+    }
+    return size;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
 template<typename T>
-void flashmap<Key, Value, Hash>::registerIterator(T * it) const {
-    it->m_IteratorNode = m_ActiveIterators.insert(m_ActiveIterators.end(), it);
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::registerHandle(T * handle) const {
+    handle->m_Node = m_Handles.insert(m_Handles.end(), handle);
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
 template<typename T>
-void flashmap<Key, Value, Hash>::unregisterIterator(T * it) const {
-    if (it->m_IteratorNode != m_ActiveIterators.end()) {
-        m_ActiveIterators.erase(it->m_IteratorNode);
-        it->m_IteratorNode = m_ActiveIterators.end();
-        it->m_Map = nullptr;
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::unregisterHandle(T * handle) const {
+    if (handle->m_Node != m_Handles.end()) {
+        m_Handles.erase(handle->m_Node);
+        handle->m_Node = m_Handles.end();
+        handle->m_Map = nullptr;
     }
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-void flashmap<Key, Value, Hash>::invalidateIterators(flashmap * map) {
-    for (auto & ptr : m_ActiveIterators) {
-        std::visit([&](auto * it) {
-            it->m_Map = map;
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename F>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::forEachHandle(F && fn) {
+    for (auto & ptr : m_Handles) {
+        std::visit(fn, ptr);
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::markErased(const std::size_t pos) {
+    forEachHandle([&](auto * handle) {
+        if (handle->m_Index == pos) handle->m_Erased = true;
+    });
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::moveHandles(const std::size_t from, const std::size_t to) {
+    forEachHandle([&](auto * handle) {
+        if (handle->m_Index == from && !handle->m_Erased) handle->m_Index = to;
+    });
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::invalidateHandles(flashmap * map) {
+    for (auto & ptr : m_Handles) {
+        std::visit([&](auto * handle) {
+            handle->m_Map = map;
         }, ptr);
     }
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
-void flashmap<Key, Value, Hash>::updateIterators() {
-    invalidateIterators(this);
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::updateHandles() {
+    invalidateHandles(this);
 }
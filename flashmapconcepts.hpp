@@ -1,13 +1,33 @@
 #pragma once
 
+#include <concepts>
+#include <type_traits>
+
 namespace yulbax::concepts {
     template<typename Key, typename HashFunc>
     concept hashable = requires(Key key, HashFunc hasher)
     { { hasher(key) } -> std::unsigned_integral; };
 
+    // Every bit of the hash depends on every bit of the key, so the map can take its bits as they are instead of mixing
+    template<typename HashFunc>
+    concept avalanching = requires { typename HashFunc::is_avalanching; };
+
     template<typename InputIt, typename Key, typename Value>
     concept inititerator = requires(InputIt it) {
         { it->first } -> std::convertible_to<Key>;
         { it->second } -> std::convertible_to<Value>;
     };
-}
\ No newline at end of file
+
+    // K is hashed and compared against stored keys as is, e.g. std::string_view for std::string keys. Both the hasher
+    // and the key equality have to declare is_transparent, as for the standard unordered containers.
+    template<typename K, typename Key, typename HashFunc, typename KeyEqual>
+    concept transparentkey = requires { typename HashFunc::is_transparent; typename KeyEqual::is_transparent; }
+                          && requires(const K & key, const Key & stored, const HashFunc & hasher, const KeyEqual & equal) {
+                                 { hasher(key) } -> std::unsigned_integral;
+                                 { equal(key, stored) } -> std::convertible_to<bool>;
+                             };
+
+    template<typename K, typename Key, typename HashFunc, typename KeyEqual>
+    concept lookupkey = std::same_as<std::remove_cvref_t<K>, Key>
+                     || transparentkey<std::remove_cvref_t<K>, Key, HashFunc, KeyEqual>;
+}
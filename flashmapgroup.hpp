@@ -0,0 +1,270 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define YULBAX_FLASHMAP_SSE2
+#endif
+
+#include "flashmapconcepts.hpp"
+#include "flashmapimpl.hpp"
+
+// GROUP PROBING
+namespace yulbax::container::flashmap::impl {
+
+    // Spreads a hash over all 64 bits with the folded 128-bit multiply of wyhash. std::hash of integers and pointers is
+    // the identity on the common standard libraries, and sequential IDs, multiples of a page size or aligned addresses
+    // would otherwise share their low bits and pile up in a few neighbouring groups. 64-bit hashes from hashers that
+    // declare is_avalanching are taken as they are; narrower ones are mixed all the same, since the fragment and the
+    // shard index are read from the top bits, which they leave zero.
+    template<typename Hash, typename HType>
+    std::uint64_t mix(const HType hash) {
+        const auto bits = static_cast<std::uint64_t>(hash);
+        if constexpr (concepts::avalanching<Hash> && sizeof(HType) == sizeof(std::uint64_t)) {
+            return bits;
+        } else {
+#if defined(__SIZEOF_INT128__)
+            // Marked as an extension so that -Wpedantic builds stay quiet about the non-standard type
+            __extension__ using Wide = unsigned __int128;
+            const auto product = static_cast<Wide>(bits) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#else
+            // No 128-bit product: the finalizer of MurmurHash3 instead
+            std::uint64_t x = bits;
+            x = (x ^ (x >> 33)) * 0xFF51AFD7ED558CCDull;
+            x = (x ^ (x >> 33)) * 0xC4CEB9FE1A85EC53ull;
+            return x ^ (x >> 33);
+#endif
+        }
+    }
+
+    // 7-bit fragment of a mixed hash, stored in the control byte of a full slot. It comes from the top bits while
+    // positions come from the bottom ones, so keys in one group rarely share it.
+    inline std::uint8_t fragment(const std::uint64_t mixed) {
+        return static_cast<std::uint8_t>(mixed >> 57);
+    }
+
+    // Only a hint: starts loading the cache line so that several probes can wait on memory at once
+    inline void prefetch(const void * address) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#elif defined(__AVX2__) || defined(YULBAX_FLASHMAP_SSE2)
+        _mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#else
+        static_cast<void>(address);
+#endif
+    }
+
+    // Set of matching slots inside a group, one bit (or one byte when Shift == 3) per slot
+    template<typename T, int Shift>
+    class BitMask {
+    public:
+        explicit BitMask(const T mask) : m_Mask(mask) {}
+
+        explicit operator bool() const { return m_Mask != 0; }
+
+        [[nodiscard]] unsigned lowest() const {
+            return static_cast<unsigned>(std::countr_zero(m_Mask)) >> Shift;
+        }
+
+        unsigned operator*() const { return lowest(); }
+
+        BitMask & operator++() {
+            m_Mask &= m_Mask - 1;
+            return *this;
+        }
+
+        // The slots from index on
+        [[nodiscard]] BitMask from(const unsigned index) const {
+            return BitMask(m_Mask & (~T{0} << (index << Shift)));
+        }
+
+        BitMask begin() const { return *this; }
+        BitMask end() const { return BitMask(0); }
+
+        bool operator==(const BitMask & other) const { return m_Mask == other.m_Mask; }
+        bool operator!=(const BitMask & other) const { return m_Mask != other.m_Mask; }
+
+    private:
+        T m_Mask;
+    };
+
+#if defined(__AVX2__)
+    struct Group {
+        static constexpr std::size_t WIDTH = 32;
+        using Mask = BitMask<std::uint32_t, 0>;
+
+        explicit Group(const Control * pos) : m_Ctrl(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos))) {}
+
+        [[nodiscard]] Mask match(const std::uint8_t h2) const {
+            return bits(_mm256_cmpeq_epi8(_mm256_set1_epi8(static_cast<char>(h2)), m_Ctrl));
+        }
+
+        [[nodiscard]] Mask matchFree() const {
+            return bits(_mm256_cmpeq_epi8(_mm256_set1_epi8(static_cast<char>(Control::FREE)), m_Ctrl));
+        }
+
+        [[nodiscard]] Mask matchFreeOrDeleted() const {
+            return bits(_mm256_cmpgt_epi8(_mm256_set1_epi8(-1), m_Ctrl));
+        }
+
+        [[nodiscard]] Mask matchFull() const {
+            return Mask(~static_cast<std::uint32_t>(_mm256_movemask_epi8(m_Ctrl)));
+        }
+
+    private:
+        static Mask bits(const __m256i v) {
+            return Mask(static_cast<std::uint32_t>(_mm256_movemask_epi8(v)));
+        }
+
+        __m256i m_Ctrl;
+    };
+#elif defined(YULBAX_FLASHMAP_SSE2)
+    struct Group {
+        static constexpr std::size_t WIDTH = 16;
+        using Mask = BitMask<std::uint32_t, 0>;
+
+        explicit Group(const Control * pos) : m_Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+        [[nodiscard]] Mask match(const std::uint8_t h2) const {
+            return bits(_mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(h2)), m_Ctrl));
+        }
+
+        [[nodiscard]] Mask matchFree() const {
+            return bits(_mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(Control::FREE)), m_Ctrl));
+        }
+
+        [[nodiscard]] Mask matchFreeOrDeleted() const {
+            return bits(_mm_cmpgt_epi8(_mm_set1_epi8(-1), m_Ctrl));
+        }
+
+        [[nodiscard]] Mask matchFull() const {
+            return Mask(~static_cast<std::uint32_t>(_mm_movemask_epi8(m_Ctrl)) & 0xFFFFu);
+        }
+
+    private:
+        static Mask bits(const __m128i v) {
+            return Mask(static_cast<std::uint32_t>(_mm_movemask_epi8(v)));
+        }
+
+        __m128i m_Ctrl;
+    };
+#else
+    // Portable SWAR fallback: eight control bytes per 64-bit word, one result bit at the top of each byte
+    struct Group {
+        static constexpr std::size_t WIDTH = 8;
+        using Mask = BitMask<std::uint64_t, 3>;
+
+        explicit Group(const Control * pos) : m_Ctrl(0) {
+            for (std::size_t i = 0; i < WIDTH; ++i)
+                m_Ctrl |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(pos[i])) << (i * 8);
+        }
+
+        // May report a false positive for a byte that follows a real match; callers verify every hit anyway
+        [[nodiscard]] Mask match(const std::uint8_t h2) const {
+            const std::uint64_t x = m_Ctrl ^ (LSBS * h2);
+            return Mask((x - LSBS) & ~x & MSBS);
+        }
+
+        [[nodiscard]] Mask matchFree() const {
+            return Mask(m_Ctrl & ~(m_Ctrl << 6) & MSBS);
+        }
+
+        [[nodiscard]] Mask matchFreeOrDeleted() const {
+            return Mask(m_Ctrl & ~(m_Ctrl << 7) & MSBS);
+        }
+
+        [[nodiscard]] Mask matchFull() const {
+            return Mask(~m_Ctrl & MSBS);
+        }
+
+    private:
+        static constexpr std::uint64_t LSBS = 0x0101010101010101ull;
+        static constexpr std::uint64_t MSBS = 0x8080808080808080ull;
+
+        std::uint64_t m_Ctrl;
+    };
+#endif
+
+    // First full slot at or after index, or size. A whole group of control bytes is tested per step, so iterating a
+    // sparse table skips its empty stretches at a group per instruction instead of a byte per loop.
+    inline std::size_t nextFull(const Control * controls, const std::size_t index, const std::size_t size) {
+        if (index >= size) return size;
+        // In a well-filled table the very next slot is often full
+        if (isFull(controls[index])) return index;
+
+        std::size_t group = index & ~(Group::WIDTH - 1);
+        auto full = Group(&controls[group]).matchFull().from(static_cast<unsigned>(index - group));
+        while (!full) {
+            group += Group::WIDTH;
+            if (group >= size) return size;
+            full = Group(&controls[group]).matchFull();
+        }
+        return group + full.lowest();
+    }
+
+    // Walks group-aligned offsets of a power-of-two table: home group first, then the following groups, or groups 1, 2,
+    // 3... further on with triangular probing. Triangular numbers modulo a power of two hit every group once.
+    template<typename Probing>
+    class ProbeSeq {
+    public:
+        ProbeSeq(const std::uint64_t mixed, const std::size_t mask)
+            : m_Mask(mask), m_Offset(static_cast<std::size_t>(mixed) & mask & ~(Group::WIDTH - 1)), m_Probes(0) {}
+
+        [[nodiscard]] std::size_t offset() const { return m_Offset; }
+        [[nodiscard]] std::size_t offset(const std::size_t i) const { return m_Offset + i; }
+        [[nodiscard]] std::size_t probes() const { return m_Probes; }
+
+        void next() {
+            ++m_Probes;
+            if constexpr (Probing::TRIANGULAR) m_Offset = (m_Offset + m_Probes * Group::WIDTH) & m_Mask;
+            else m_Offset = (m_Offset + Group::WIDTH) & m_Mask;
+        }
+
+    private:
+        std::size_t m_Mask;
+        std::size_t m_Offset;
+        std::size_t m_Probes;
+    };
+
+    // First full slot whose fragment matches and that isMatch accepts, or size once the probe chain ends. inspected is
+    // set to the number of groups looked at.
+    template<typename Probing, typename IsMatch>
+    std::size_t probe(const Control * controls, const std::size_t size, const std::uint64_t mixed, IsMatch && isMatch,
+                      std::size_t & inspected) {
+        const std::size_t groups = size / Group::WIDTH;
+        const std::uint8_t h2 = fragment(mixed);
+
+        ProbeSeq<Probing> seq(mixed, size - 1);
+        for (; seq.probes() < groups; seq.next()) {
+            const Group group(&controls[seq.offset()]);
+
+            for (const unsigned i : group.match(h2)) {
+                if (isMatch(seq.offset(i))) {
+                    inspected = seq.probes() + 1;
+                    return seq.offset(i);
+                }
+            }
+
+            if (group.matchFree()) {
+                inspected = seq.probes() + 1;
+                return size;
+            }
+        }
+
+        inspected = groups;
+        return size;
+    }
+
+    template<typename Probing, typename IsMatch>
+    std::size_t probe(const Control * controls, const std::size_t size, const std::uint64_t mixed, IsMatch && isMatch) {
+        std::size_t inspected;
+        return probe<Probing>(controls, size, mixed, std::forward<IsMatch>(isMatch), inspected);
+    }
+}
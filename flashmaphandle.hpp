@@ -0,0 +1,102 @@
+#pragma once
+
+// Registered reference to one element: follows it through rehashes, migration and backward shifts, and reports when
+// the element is erased. Every handle costs a list node and is updated by each operation that moves elements.
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+template<typename HandleType, typename MapType>
+class flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::Handle {
+    using ListPos = typename HandleList::iterator;
+    using Pair    = std::conditional_t<std::is_const_v<MapType>, const std::pair<const Key, Value>, std::pair<const Key, Value>>;
+public:
+    using value_type = std::pair<const Key, HandleType>;
+
+    Handle() : m_Map(nullptr), m_Index(), m_Erased(false) {}
+
+    template<typename Iterator> requires concepts::isIterator<Iterator, Key, Value, Hash, KeyEqual, Allocator, Policy>
+                                      && (std::is_const_v<MapType> || std::same_as<Iterator, iterator>)
+    Handle(const Iterator & it) : m_Map(it.m_Map), m_Index(it.m_Index), m_Erased(it.m_Erased) {
+        it.checkGeneration();
+        // A handle on end() (a missed find) refers to no element: it starts out erased, so that no rehash, migration
+        // or shift ever reads a slot at its index
+        if (m_Map && m_Index >= m_Map->endIndex()) m_Erased = true;
+        if (m_Map) m_Map->registerHandle(this);
+    }
+
+    Handle(const Handle & other) : m_Map(other.m_Map), m_Index(other.m_Index), m_Erased(other.m_Erased) {
+        if (m_Map) m_Map->registerHandle(this);
+    }
+
+    Handle & operator=(const Handle & other) {
+        if (this == &other) return *this;
+
+        if (m_Map) m_Map->unregisterHandle(this);
+        m_Map = other.m_Map;
+        m_Index = other.m_Index;
+        m_Erased = other.m_Erased;
+        if (m_Map) m_Map->registerHandle(this);
+
+        return *this;
+    }
+
+    Handle(Handle && other) noexcept : m_Map(other.m_Map), m_Index(other.m_Index), m_Erased(other.m_Erased) {
+        m_Node = other.m_Node;
+        other.m_Map = nullptr;
+        other.m_Node = {};
+        if (m_Map) *m_Node = this;
+    }
+
+    Handle & operator=(Handle && other) noexcept {
+        if (this == &other) return *this;
+
+        if (m_Map) m_Map->unregisterHandle(this);
+        m_Map = other.m_Map;
+        m_Index = other.m_Index;
+        m_Erased = other.m_Erased;
+        m_Node = other.m_Node;
+        if (m_Map) *m_Node = this;
+
+        other.m_Map = nullptr;
+        other.m_Node = {};
+
+        return *this;
+    }
+
+    ~Handle() {
+        if (m_Map) m_Map->unregisterHandle(this);
+    }
+
+    [[nodiscard]] bool valid() const {
+        return m_Map && !m_Erased && m_Index < m_Map->endIndex() && isFull(m_Map->controlAt(m_Index));
+    }
+
+    auto & get() const {
+        isAlive();
+        return *std::launder(reinterpret_cast<Pair*>(&m_Map->kvAt(m_Index)));
+    }
+
+    auto & operator*() const {
+        return get();
+    }
+
+    auto operator->() const {
+        return &get();
+    }
+
+private:
+    void isAlive() const {
+        if (!m_Map) {
+            throw std::runtime_error("Handle invalidated: container was destroyed");
+        }
+
+        if (!valid()) {
+            throw std::out_of_range("Attempted to access a deleted value");
+        }
+    }
+
+    MapType * m_Map;
+    std::size_t m_Index;
+    bool m_Erased;
+    ListPos m_Node;
+
+    friend class flashmap;
+};
@@ -1,37 +1,212 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "flashmappolicy.hpp"
+
 // NESTED OBJECTS
 namespace yulbax::container::flashmap::impl {
 
-    enum class Status : uint8_t { FREE, OCCUPIED, DELETED };
+    // One control byte per slot: FREE, DELETED or, for a full slot, the 7-bit hash fragment (0..127)
+    enum class Control : std::int8_t { FREE = -128, DELETED = -2 };
+
+    inline bool isFull(const Control control) {
+        return static_cast<std::int8_t>(control) >= 0;
+    }
+
+    // Raw storage for one pair: only full slots hold a live object
+    template<typename K, typename V>
+    union Slot {
+        Slot() {}
+        ~Slot() {}
 
+        std::pair<K,V> kv;
+    };
+
+    // Slot of an interleaved layout that stores hashes: a candidate's key and full hash arrive in one cache line
     template<typename K, typename V, typename HType>
+    struct HashedSlot {
+        HashedSlot() {}
+        ~HashedSlot() {}
+
+        union {
+            std::pair<K,V> kv;
+        };
+        HType hash;
+    };
+
+    // Stands in for the hash array of layouts that keep no separate one
+    struct NoHashes {
+        NoHashes() = default;
+        template<typename Alloc>
+        NoHashes(std::size_t, const Alloc &) {}
+
+        void swap(NoHashes &) noexcept {}
+        void clear() noexcept {}
+    };
+
+    // Small trivially copyable keys hash in a few instructions, and a stored hash would be as large as the key itself
+    template<typename Layout, typename K>
+    struct ResolveLayout {
+        using type = Layout;
+    };
+
+    template<typename K>
+    struct ResolveLayout<auto_layout, K> {
+        using type = aos_layout<!(std::is_trivially_copyable_v<K> && sizeof(K) <= sizeof(std::uint64_t))>;
+    };
+
+    // The map's allocator, rebound, backs all arrays and constructs the pairs (uses-allocator construction for
+    // std::pmr). Moving between unequal allocators that do not propagate relocates the elements one by one.
+    template<typename K, typename V, typename HType, typename Alloc, typename Layout>
     struct Vectors {
-        explicit Vectors(std::size_t size) : KVs(size), statuses(size), hashes(size) {}
+        using Key      = K;
+        using Value    = V;
+        using HashType = HType;
+        using Traits   = std::allocator_traits<Alloc>;
+        template<typename T>
+        using Rebind = typename Traits::template rebind_alloc<T>;
+
+        static constexpr bool STORE_HASH = Layout::STORE_HASH;
+        static constexpr bool SPLIT_HASHES = STORE_HASH && !Layout::INTERLEAVED;
+
+        using Entry  = std::conditional_t<STORE_HASH && Layout::INTERLEAVED, HashedSlot<K,V,HType>, Slot<K,V>>;
+        using Hashes = std::conditional_t<SPLIT_HASHES, std::vector<HType, Rebind<HType>>, NoHashes>;
+
+        // Bytes one slot takes across all arrays
+        static constexpr std::size_t SLOT_BYTES = sizeof(Entry) + sizeof(Control) + (SPLIT_HASHES ? sizeof(HType) : 0);
+
+        Vectors(std::size_t size, const Alloc & alloc)
+            : slots(size, Rebind<Entry>(alloc)), controls(size, Control::FREE, Rebind<Control>(alloc)),
+              hashes(size, Rebind<HType>(alloc)) {}
+
+        Vectors(const Vectors & other) : Vectors(other, Traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        // Delegating first makes the destructor responsible for whatever was copied if a copy throws
+        Vectors(const Vectors & other, const Alloc & alloc) : Vectors(other.size(), alloc) {
+            for (std::size_t i = 0; i < size(); ++i) {
+                if (!isFull(other.controls[i])) continue;
+                construct(i, other.kv(i));
+                if constexpr (STORE_HASH) setHash(i, other.hash(i));
+                controls[i] = other.controls[i];
+            }
+            controls = other.controls;
+        }
+
+        Vectors(Vectors && other) noexcept = default;
 
-        std::vector<std::pair<K,V>> KVs;
-        std::vector<Status> statuses;
-        std::vector<HType> hashes;
+        Vectors & operator=(const Vectors & other) {
+            if (this == &other) return *this;
+            Vectors copy(other, Traits::propagate_on_container_copy_assignment::value ? other.get_allocator() : get_allocator());
+            destroyAll();
+            steal(copy);
+            return *this;
+        }
+
+        Vectors & operator=(Vectors && other) noexcept(Traits::propagate_on_container_move_assignment::value
+                                                    || Traits::is_always_equal::value) {
+            if (this == &other) return *this;
+            if constexpr (Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value) {
+                destroyAll();
+                slots = std::move(other.slots);
+                controls = std::move(other.controls);
+                hashes = std::move(other.hashes);
+            } else if (get_allocator() == other.get_allocator()) {
+                destroyAll();
+                steal(other);
+            } else {
+                Vectors moved(other.size(), get_allocator());
+                for (std::size_t i = 0; i < other.size(); ++i) {
+                    if (isFull(other.controls[i])) moved.transfer(i, other, i);
+                }
+                moved.controls = other.controls;
+                std::ranges::fill(other.controls, Control::FREE);
+                destroyAll();
+                steal(moved);
+            }
+            return *this;
+        }
+
+        ~Vectors() {
+            destroyAll();
+        }
+
+        [[nodiscard]] Alloc get_allocator() const {
+            return Alloc(slots.get_allocator());
+        }
+
+        std::vector<Entry, Rebind<Entry>> slots;
+        std::vector<Control, Rebind<Control>> controls;
+        [[no_unique_address]] Hashes hashes;
+
+        std::pair<K,V> & kv(const std::size_t index) {
+            return slots[index].kv;
+        }
+
+        const std::pair<K,V> & kv(const std::size_t index) const {
+            return slots[index].kv;
+        }
 
-        std::tuple<std::pair<K,V>&, Status&, HType&> operator[](const std::size_t index) {
-            return {KVs[index], statuses[index], hashes[index]};
+        [[nodiscard]] HType hash(const std::size_t index) const requires STORE_HASH {
+            if constexpr (SPLIT_HASHES) return hashes[index];
+            else return slots[index].hash;
         }
 
-        std::tuple<const std::pair<K,V>&, const Status&, const HType&> operator[](const std::size_t index) const {
-            return {KVs[index], statuses[index], hashes[index]};
+        void setHash(const std::size_t index, const HType hash) {
+            if constexpr (SPLIT_HASHES) hashes[index] = hash;
+            else if constexpr (STORE_HASH) slots[index].hash = hash;
         }
 
         [[nodiscard]] std::size_t size() const {
-            return KVs.size();
+            return slots.size();
         }
 
-        void resize(const std::size_t size) {
-            KVs.resize(size);
-            statuses.resize(size);
-            hashes.resize(size);
+        // The caller marks the slot full afterwards, so a throwing constructor leaves nothing to undo
+        template<typename... Args>
+        void construct(const std::size_t index, Args &&... args) {
+            Alloc alloc = get_allocator();
+            Traits::construct(alloc, &slots[index].kv, std::forward<Args>(args)...);
+        }
+
+        void destroy(const std::size_t index) {
+            Alloc alloc = get_allocator();
+            Traits::destroy(alloc, &slots[index].kv);
         }
-    };
-}
 
+        // Moves the pair at index of from, and its hash, into the raw slot at to, leaving raw storage behind; control
+        // bytes are the caller's
+        void transfer(const std::size_t to, Vectors & from, const std::size_t index) {
+            construct(to, std::move(from.kv(index)));
+            if constexpr (STORE_HASH) setHash(to, from.hash(index));
+            from.destroy(index);
+        }
 
+        void clear() {
+            destroyAll();
+            std::ranges::fill(controls, Control::FREE);
+        }
 
+    private:
+        // Takes over other's arrays; only valid between equal allocators, with this one's elements already destroyed
+        void steal(Vectors & other) noexcept {
+            slots.swap(other.slots);
+            controls.swap(other.controls);
+            hashes.swap(other.hashes);
+            other.slots.clear();
+            other.controls.clear();
+            other.hashes.clear();
+        }
+
+        void destroyAll() {
+            if constexpr (!std::is_trivially_destructible_v<std::pair<K,V>>) {
+                for (std::size_t i = 0; i < controls.size(); ++i) {
+                    if (isFull(controls[i])) destroy(i);
+                }
+            }
+        }
+    };
+}
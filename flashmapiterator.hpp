@@ -1,15 +1,17 @@
 #pragma once
 
 namespace concepts {
-    template<typename IteratorType, typename Key, typename Value, typename Hash>
-    concept isIterator = std::same_as<IteratorType, typename flashmap<Key, Value, Hash>::iterator>
-                      || std::same_as<IteratorType, typename flashmap<Key, Value, Hash>::const_iterator>;
+    template<typename IteratorType, typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy>
+    concept isIterator = std::same_as<IteratorType, typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::iterator>
+                      || std::same_as<IteratorType, typename flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::const_iterator>;
 }
 
-template<typename Key, typename Value, typename Hash> requires yulbax::concepts::hashable<Key, Hash>
+// Plain position in the table: cheap to create, copy and drop, but invalidated whenever elements may move (rehash,
+// migration step, erase, clear). Debug builds catch use after such a change through the map's generation counter.
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
 template<typename ValueType, typename MapType>
-class flashmap<Key, Value, Hash>::Iterator {
-    using ListPos = typename std::list<IteratorPtr>::iterator;
+class flashmap<Key, Value, Hash, KeyEqual, Allocator, Policy>::Iterator {
+    using Pair = std::conditional_t<std::is_const_v<MapType>, const std::pair<const Key, Value>, std::pair<const Key, Value>>;
 public:
     using iterator_category = std::forward_iterator_tag;
     using value_type = std::pair<const Key, ValueType>;
@@ -17,106 +19,88 @@ public:
     using pointer = value_type*;
     using reference = value_type&;
 
-    Iterator() : m_Map(nullptr), m_Index() {}
+    Iterator() : m_Map(nullptr), m_Index(), m_Generation(), m_Erased(false) {}
 
-    Iterator(MapType * map, const std::size_t index) : m_Map(map), m_Index(index) {
-        if (m_Map) m_Map->registerIterator(this);
-    }
-
-    Iterator(const Iterator & other) : m_Index(other.m_Index) {
-        m_Map = other.m_Map;
-        if (m_Map) m_Map->registerIterator(this);
-    }
-
-    Iterator & operator=(const Iterator & other) {
-        if (this == &other) return *this;
-
-        if (m_Map) m_Map->unregisterIterator(this);
-        m_Map = other.m_Map;
-        m_Index = other.m_Index;
-        if (m_Map) m_Map->registerIterator(this);
-
-        return *this;
-    }
-
-    Iterator(Iterator && other) noexcept : m_Index(other.m_Index) {
-        m_Map = other.m_Map;
-        m_IteratorNode = other.m_IteratorNode;
-        other.m_Map = nullptr;
-        other.m_IteratorNode = {};
-        if (m_Map) *m_IteratorNode = this;
-    }
-
-    Iterator& operator=(Iterator && other) noexcept {
-        if (this == &other) return *this;
-
-        if (m_Map) m_Map->unregisterIterator(this);
-        m_Map = other.m_Map;
-        m_Index = other.m_Index;
-        m_IteratorNode = other.m_IteratorNode;
-        if (m_Map) *m_IteratorNode = this;
+    Iterator(MapType * map, const std::size_t index)
+        : m_Map(map), m_Index(index), m_Generation(map->m_Generation), m_Erased(false) {}
 
-        other.m_Map = nullptr;
-        other.m_IteratorNode = {};
-
-        return *this;
-    }
-
-    ~Iterator() {
-        if (m_Map) m_Map->unregisterIterator(this);
-    }
+    // iterator -> const_iterator
+    template<typename Other> requires std::is_const_v<MapType> && std::same_as<Other, Iterator<Value, flashmap>>
+    Iterator(const Other & other)
+        : m_Map(other.m_Map), m_Index(other.m_Index), m_Generation(other.m_Generation), m_Erased(other.m_Erased) {}
 
     Iterator & operator++() {
+        checkGeneration();
         skipToOccupied();
         return *this;
     }
 
+    Iterator operator++(int) {
+        Iterator copy = *this;
+        ++*this;
+        return copy;
+    }
+
     auto & operator*() const {
         isAlive();
-        return *std::launder(reinterpret_cast<std::pair<const Key, Value>*>(&m_Map->m_Data.KVs[m_Index]));
+        return *std::launder(reinterpret_cast<Pair*>(&m_Map->kvAt(m_Index)));
     }
 
     auto operator->() const {
         isAlive();
-        return std::launder(reinterpret_cast<std::pair<const Key, Value>*>(&m_Map->m_Data.KVs[m_Index]));
+        return std::launder(reinterpret_cast<Pair*>(&m_Map->kvAt(m_Index)));
     }
 
-    template<typename Iterator> requires concepts::isIterator<Iterator, Key, Value, Hash>
+    template<typename Iterator> requires concepts::isIterator<Iterator, Key, Value, Hash, KeyEqual, Allocator, Policy>
     bool operator==(const Iterator & other) const {
-        if (m_Map != other.m_Map || !m_Map) return false;
-        if (other.m_Index != other.m_Map->m_Data.size()) other.isAlive();
-        if (m_Index != m_Map->m_Data.size()) isAlive();
-        return m_Index == other.m_Index;
+        return m_Map == other.m_Map && m_Index == other.m_Index;
     }
 
-    template<typename Iterator> requires concepts::isIterator<Iterator, Key, Value, Hash>
+    template<typename Iterator> requires concepts::isIterator<Iterator, Key, Value, Hash, KeyEqual, Allocator, Policy>
     bool operator!=(const Iterator & other) const {
         return !(*this == other);
     }
 
 private:
+    void checkGeneration() const {
+#ifndef NDEBUG
+        if (m_Map && m_Generation != m_Map->m_Generation) {
+            throw std::logic_error("Iterator invalidated: elements moved since it was obtained");
+        }
+#endif
+    }
+
     void isAlive() const {
+#ifndef NDEBUG
         if (!m_Map) {
-            throw std::runtime_error("Iterator invalidated: container was destroyed");
+            throw std::runtime_error("Iterator is not bound to a container");
         }
 
-        if (m_Map->m_Data.statuses[m_Index] == Status::DELETED) {
+        checkGeneration();
+        if (m_Erased || m_Index >= m_Map->endIndex() || !isFull(m_Map->controlAt(m_Index))) {
             throw std::out_of_range("Attempted to access a deleted value");
         }
+#endif
     }
 
+    // An erased slot may have been refilled by backward shift; that element has not been visited yet
     void skipToOccupied() {
-        do {
-            ++m_Index;
-        } while (m_Index != m_Map->m_Data.size()
-              && m_Map->m_Data.statuses[m_Index] != Status::OCCUPIED);
+        if (m_Erased) {
+            m_Erased = false;
+            if (m_Index == m_Map->endIndex() || isFull(m_Map->controlAt(m_Index))) return;
+        }
+
+        m_Index = m_Map->nextFull(m_Index + 1);
     }
 
     MapType * m_Map;
     std::size_t m_Index;
-    ListPos m_IteratorNode;
+    std::size_t m_Generation;
+    bool m_Erased;
 
     friend class flashmap;
     friend class Iterator<Value, flashmap>;
     friend class Iterator<const Value, const flashmap>;
+    friend class Handle<Value, flashmap>;
+    friend class Handle<const Value, const flashmap>;
 };
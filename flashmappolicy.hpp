@@ -0,0 +1,45 @@
+#pragma once
+
+namespace yulbax {
+
+    // Stats policies: no_stats compiles every counter away, collect_stats feeds flashmap::stats()
+    struct no_stats {};
+    struct collect_stats {};
+
+    // Layout policies. aos_layout keeps each pair and its full hash together in one slot, soa_layout keeps the hashes
+    // in an array of their own. Without a stored hash, rehashing and erasing hash the keys again.
+    template<bool StoreHash = true>
+    struct aos_layout {
+        static constexpr bool INTERLEAVED = true;
+        static constexpr bool STORE_HASH = StoreHash;
+    };
+
+    template<bool StoreHash = true>
+    struct soa_layout {
+        static constexpr bool INTERLEAVED = false;
+        static constexpr bool STORE_HASH = StoreHash;
+    };
+
+    // Chosen from the key type: small trivially copyable keys are rehashed, any other key keeps its hash in its slot
+    struct auto_layout {};
+
+    // Probing policies: the order in which groups are visited after the home group. group_linear_probing moves on to
+    // the next group, which keeps a probe sequence in consecutive memory and lets erase shift elements back instead of
+    // leaving tombstones. triangular_probing jumps 1, 2, 3... groups ahead, which breaks up the clusters that keys with
+    // colliding home groups build, at the price of a tombstone whenever an erase hits a group without a FREE slot.
+    struct group_linear_probing {
+        static constexpr bool TRIANGULAR = false;
+    };
+
+    struct triangular_probing {
+        static constexpr bool TRIANGULAR = true;
+    };
+
+    // Compile-time options of a flashmap, bundled so that adding one does not shift the other template parameters
+    template<typename Stats = no_stats, typename Layout = auto_layout, typename Probing = group_linear_probing>
+    struct flashmap_policy {
+        using stats = Stats;
+        using layout = Layout;
+        using probing = Probing;
+    };
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "flashmapgroup.hpp"
+
+// SNAPSHOT FORMAT
+// A header followed by the arrays of one table exactly as they sit in memory: control bytes, hashes (split layouts
+// only), slots.
+// Every array starts on an ALIGNMENT boundary, so a mapped file can be probed in place.
+namespace yulbax::container::flashmap::impl {
+
+    struct SnapshotHeader {
+        static constexpr char MAGIC[8] = {'F', 'L', 'A', 'S', 'H', 'M', 'A', 'P'};
+        static constexpr std::uint32_t VERSION = 2;
+        static constexpr std::uint32_t ENDIAN_MARK = 0x01020304;
+        static constexpr std::size_t ALIGNMENT = 64;
+
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        // The probe order depends on the group width, i.e. on the instruction set the writer was built for, and on the
+        // probing policy (1 for triangular)
+        std::uint64_t groupWidth;
+        std::uint64_t probing;
+        std::uint64_t keySize;
+        std::uint64_t valueSize;
+        std::uint64_t hashSize;
+        std::uint64_t slotSize;
+        std::uint64_t slots;
+        std::uint64_t count;
+        std::uint64_t deleted;
+        std::uint64_t controlsOffset;
+        std::uint64_t hashesOffset;
+        std::uint64_t slotsOffset;
+        std::uint64_t fileSize;
+
+        static std::uint64_t alignUp(const std::uint64_t offset) {
+            return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+
+        // Data is the table's Vectors type: the layout decides whether hashes sit in their own array, in the slots or
+        // nowhere, and the sizes recorded here tell the three apart
+        template<typename Data, typename Probing>
+        static SnapshotHeader make(const std::size_t slots, const std::size_t count, const std::size_t deleted) {
+            SnapshotHeader header{};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.byteOrder = ENDIAN_MARK;
+            header.groupWidth = Group::WIDTH;
+            header.probing = Probing::TRIANGULAR;
+            header.keySize = sizeof(typename Data::Key);
+            header.valueSize = sizeof(typename Data::Value);
+            header.hashSize = Data::STORE_HASH ? sizeof(typename Data::HashType) : 0;
+            header.slotSize = sizeof(typename Data::Entry);
+            header.slots = slots;
+            header.count = count;
+            header.deleted = deleted;
+            header.controlsOffset = alignUp(sizeof(SnapshotHeader));
+            header.hashesOffset = alignUp(header.controlsOffset + slots * sizeof(Control));
+            header.slotsOffset = alignUp(header.hashesOffset + (Data::SPLIT_HASHES ? slots * header.hashSize : 0));
+            header.fileSize = header.slotsOffset + slots * header.slotSize;
+            return header;
+        }
+
+        // Throws unless the snapshot holds this table type; returns whether its probe order is this build's as well
+        template<typename Data, typename Probing>
+        bool validate(const std::uint64_t actualSize) const {
+            if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) throw std::runtime_error("Not a flashmap snapshot");
+            if (version != VERSION) throw std::runtime_error("Unsupported snapshot version " + std::to_string(version));
+            if (byteOrder != ENDIAN_MARK) throw std::runtime_error("Snapshot was written with a different byte order");
+            const SnapshotHeader expected = make<Data, Probing>(slots, count, deleted);
+            if (keySize != expected.keySize || valueSize != expected.valueSize) {
+                throw std::runtime_error("Snapshot was written for different key or value types");
+            }
+            if (hashSize != expected.hashSize || slotSize != expected.slotSize) {
+                throw std::runtime_error("Snapshot was written with a different layout");
+            }
+            SnapshotHeader same = expected;
+            same.groupWidth = groupWidth;
+            same.probing = probing;
+            if (slots == 0 || (slots & (slots - 1)) != 0 || count + deleted > slots || fileSize != actualSize
+             || !(*this == same)) {
+                throw std::runtime_error("Snapshot is corrupt");
+            }
+            return groupWidth == expected.groupWidth && probing == expected.probing;
+        }
+
+        bool operator==(const SnapshotHeader & other) const {
+            return std::memcmp(this, &other, sizeof(SnapshotHeader)) == 0;
+        }
+    };
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include "flashmapgroup.hpp"
+#include "flashmappolicy.hpp"
+
+namespace yulbax {
+
+    // Point-in-time copy of a map's state, see flashmap::stats(). The lookup and rehash counters stay zero unless the
+    // map collects stats.
+    struct flashmap_stats {
+        static constexpr std::size_t PROBE_BUCKETS = 16;
+
+        std::size_t size = 0;
+        std::size_t bucket_count = 0;
+        float load_factor = 0;
+        // DELETED slots of the current table; they lengthen probes and count towards the next growth
+        std::size_t tombstones = 0;
+        float tombstone_ratio = 0;
+        // An incremental rehash is in flight and bucket_count includes the old table
+        bool migrating = false;
+        std::size_t handles = 0;
+        // Table arrays and handle nodes; memory owned by the keys and values themselves is not included
+        std::size_t memory_bytes = 0;
+
+        // Lookups by groups inspected: [i] counts those that inspected i + 1 groups, the last bucket all longer ones
+        std::array<std::uint64_t, PROBE_BUCKETS> hit_probes{};
+        std::array<std::uint64_t, PROBE_BUCKETS> miss_probes{};
+
+        // Rebuilds and incremental migrations started, and the cost of moving elements for either
+        std::uint64_t rehashes = 0;
+        std::uint64_t elements_moved = 0;
+        std::uint64_t bytes_moved = 0;
+        std::chrono::nanoseconds rehash_time{0};
+        // Longest single stop: a whole rebuild, or one migration step with incremental rehashing
+        std::chrono::nanoseconds longest_rehash_pause{0};
+    };
+}
+
+// INSTRUMENTATION
+namespace yulbax::container::flashmap::impl {
+
+    template<typename Policy>
+    class Stats;
+
+    template<>
+    class Stats<no_stats> {
+    public:
+        struct Timer {};
+
+        void lookup(bool, std::size_t) {}
+        void rehashStarted() {}
+        [[nodiscard]] Timer start() const { return {}; }
+        void moved(Timer, std::size_t, std::size_t) {}
+        void fill(flashmap_stats &) const {}
+        void reset() {}
+    };
+
+    template<>
+    class Stats<collect_stats> {
+    public:
+        using Timer = std::chrono::steady_clock::time_point;
+
+        // Most lookups finish in their first group. Those are only counted, at fixed addresses: a histogram bucket
+        // picked by the probe's outcome would make the next lookups' loads wait for it, serialising their cache misses.
+        void lookup(const bool hit, const std::size_t groups) {
+            ++m_Lookups;
+            m_Found += hit;
+            if (groups > 1) [[unlikely]] {
+                auto & histogram = hit ? m_Hits : m_Misses;
+                ++histogram[std::min(groups, flashmap_stats::PROBE_BUCKETS) - 1];
+            }
+        }
+
+        void rehashStarted() {
+            ++m_Rehashes;
+        }
+
+        [[nodiscard]] Timer start() const {
+            return std::chrono::steady_clock::now();
+        }
+
+        void moved(const Timer started, const std::size_t elements, const std::size_t bytes) {
+            const auto pause = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started);
+            m_Elements += elements;
+            m_Bytes += bytes;
+            m_Time += pause;
+            m_LongestPause = std::max(m_LongestPause, pause);
+        }
+
+        void fill(flashmap_stats & stats) const {
+            stats.hit_probes = m_Hits;
+            stats.miss_probes = m_Misses;
+            stats.hit_probes[0] = m_Found - std::accumulate(m_Hits.begin() + 1, m_Hits.end(), std::uint64_t{0});
+            stats.miss_probes[0] = m_Lookups - m_Found - std::accumulate(m_Misses.begin() + 1, m_Misses.end(), std::uint64_t{0});
+            stats.rehashes = m_Rehashes;
+            stats.elements_moved = m_Elements;
+            stats.bytes_moved = m_Bytes;
+            stats.rehash_time = m_Time;
+            stats.longest_rehash_pause = m_LongestPause;
+        }
+
+        void reset() {
+            *this = Stats();
+        }
+
+    private:
+        std::uint64_t m_Lookups = 0;
+        std::uint64_t m_Found = 0;
+        // Bucket 0 stays unused, fill() derives it from the totals
+        std::array<std::uint64_t, flashmap_stats::PROBE_BUCKETS> m_Hits{};
+        std::array<std::uint64_t, flashmap_stats::PROBE_BUCKETS> m_Misses{};
+        std::uint64_t m_Rehashes = 0;
+        std::uint64_t m_Elements = 0;
+        std::uint64_t m_Bytes = 0;
+        std::chrono::nanoseconds m_Time{0};
+        std::chrono::nanoseconds m_LongestPause{0};
+    };
+
+    // Clusters of one table as flashmap::dump_layout prints them. A probe only stops at a group with a FREE slot, so
+    // runs of groups without one are what lookups pay for; the map shows how evenly they are spread.
+    inline void dumpLayout(std::ostream & out, const Control * controls, const std::size_t size) {
+        static constexpr char LEVELS[] = " .:-=+*#%@";
+        static constexpr std::size_t COLUMNS = 64;
+        static constexpr std::size_t MAX_CELLS = COLUMNS * 16;
+        static constexpr std::size_t RUN_BUCKETS = 16;
+
+        const std::size_t groups = size / Group::WIDTH;
+        std::size_t full = 0;
+        std::size_t deleted = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            if (isFull(controls[i])) ++full;
+            else if (controls[i] == Control::DELETED) ++deleted;
+        }
+
+        // Runs of groups without a FREE slot, bucketed by powers of two; a run across the end of the table counts twice
+        std::array<std::size_t, RUN_BUCKETS> runs{};
+        std::size_t closedGroups = 0;
+        std::size_t longest = 0;
+        std::size_t run = 0;
+        for (std::size_t g = 0; g <= groups; ++g) {
+            if (g < groups && !Group(&controls[g * Group::WIDTH]).matchFree()) {
+                ++run;
+                ++closedGroups;
+                continue;
+            }
+            if (run) ++runs[std::min<std::size_t>(std::bit_width(run) - 1, RUN_BUCKETS - 1)];
+            longest = std::max(longest, run);
+            run = 0;
+        }
+
+        out << "  " << full << " full, " << deleted << " deleted, " << size - full - deleted << " free in " << size
+            << " slots; " << closedGroups << " of " << groups << " groups without a free slot, longest run "
+            << longest << '\n';
+        for (std::size_t i = 0; i < RUN_BUCKETS; ++i) {
+            if (!runs[i]) continue;
+            const std::size_t low = std::size_t{1} << i;
+            out << "    run of " << low;
+            if (low > 1) out << '-' << (i + 1 == RUN_BUCKETS ? std::string("...") : std::to_string(2 * low - 1));
+            out << " groups: " << runs[i] << '\n';
+        }
+
+        // Occupancy map, full and deleted slots alike: ' ' is an empty cell and '@' a completely used one
+        const std::size_t cells = std::min(groups, MAX_CELLS);
+        const std::size_t perCell = size / cells;
+        out << "  occupancy, " << perCell << " slots per cell:\n";
+        for (std::size_t cell = 0; cell < cells; ++cell) {
+            if (cell % COLUMNS == 0) out << "    |";
+            std::size_t used = 0;
+            for (std::size_t i = cell * perCell; i < (cell + 1) * perCell; ++i) used += controls[i] != Control::FREE;
+            out << LEVELS[used == 0 ? 0 : 1 + used * 8 / perCell];
+            if (cell % COLUMNS == COLUMNS - 1 || cell + 1 == cells) out << "|\n";
+        }
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "flashmap.hpp"
+
+namespace yulbax {
+
+    // Read-only map over a snapshot written by flashmap::save, with the same Hash, KeyEqual and Policy. The file is
+    // mapped, not read: opening costs a header check and pages are faulted in as lookups touch them. POSIX only.
+    template<typename Key,
+             typename Value,
+             typename Hash = std::hash<Key>,
+             typename KeyEqual = std::equal_to<Key>,
+             typename Policy = flashmap_policy<>>
+             requires concepts::hashable<Key, Hash>
+
+    class flashmap_view {
+
+        using HashType = decltype(std::declval<Hash>()(std::declval<Key>()));
+        using Control  = container::flashmap::impl::Control;
+        // Only names the table's types: the layout has to be the one the snapshot was saved with
+        using Layout   = typename container::flashmap::impl::ResolveLayout<typename Policy::layout, Key>::type;
+        using Data     = container::flashmap::impl::Vectors<Key, Value, HashType,
+                                                            std::allocator<std::pair<const Key, Value>>, Layout>;
+        using Slot     = typename Data::Entry;
+        using Header   = container::flashmap::impl::SnapshotHeader;
+        using Probing  = typename Policy::probing;
+
+        static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                      "Snapshots store keys and values as raw bytes");
+
+    public:
+
+        using key_type    = Key;
+        using mapped_type = Value;
+        using value_type  = std::pair<Key, Value>;
+
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = std::pair<Key, Value>;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const value_type *;
+            using reference         = const value_type &;
+
+            const_iterator() = default;
+
+            reference operator*() const { return m_View->m_Slots[m_Index].kv; }
+            pointer operator->() const { return &m_View->m_Slots[m_Index].kv; }
+
+            const_iterator & operator++() {
+                m_Index = m_View->nextFull(m_Index + 1);
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            bool operator==(const const_iterator & other) const { return m_Index == other.m_Index; }
+
+        private:
+            friend class flashmap_view;
+
+            const_iterator(const flashmap_view * view, const std::size_t index) : m_View(view), m_Index(index) {}
+
+            const flashmap_view * m_View = nullptr;
+            std::size_t m_Index = 0;
+        };
+
+        using iterator = const_iterator;
+
+        explicit flashmap_view(const std::filesystem::path & path);
+
+        flashmap_view(const flashmap_view &) = delete;
+        flashmap_view & operator=(const flashmap_view &) = delete;
+        flashmap_view(flashmap_view && other) noexcept;
+        flashmap_view & operator=(flashmap_view && other) noexcept;
+
+        ~flashmap_view();
+
+        [[nodiscard]] const_iterator find(const Key & key) const;
+        [[nodiscard]] bool contains(const Key & key) const;
+        [[nodiscard]] const Value & at(const Key & key) const;
+
+        [[nodiscard]] const_iterator begin() const;
+        [[nodiscard]] const_iterator end() const;
+
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] std::size_t bucket_count() const;
+
+        // Asks the kernel to read the whole file ahead instead of faulting it in lookup by lookup
+        void warmup() const;
+
+    private:
+        [[nodiscard]] std::size_t findIndex(const Key & key) const;
+        [[nodiscard]] std::size_t nextFull(std::size_t index) const;
+        void unmap() noexcept;
+
+        void * m_Mapping = nullptr;
+        std::size_t m_Length = 0;
+        const Control * m_Controls = nullptr;
+        const HashType * m_Hashes = nullptr;
+        const Slot * m_Slots = nullptr;
+        std::size_t m_Size = 0;
+        std::size_t m_Count = 0;
+        Hash m_Hasher;
+        [[no_unique_address]] KeyEqual m_KeyEqual;
+    };
+
+    #include "flashmapview.tpp"
+}
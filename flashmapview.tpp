@@ -0,0 +1,139 @@
+#pragma once
+
+// PUBLIC METHODS
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap_view<Key, Value, Hash, KeyEqual, Policy>::flashmap_view(const std::filesystem::path & path) : m_Hasher(), m_KeyEqual() {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open snapshot: " + path.string());
+
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error("Snapshot is corrupt");
+    }
+
+    m_Length = static_cast<std::size_t>(info.st_size);
+    m_Mapping = ::mmap(nullptr, m_Length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m_Mapping == MAP_FAILED) {
+        m_Mapping = nullptr;
+        throw std::runtime_error("Cannot map snapshot: " + path.string());
+    }
+
+    try {
+        const auto * bytes = static_cast<const std::byte *>(m_Mapping);
+        const auto * header = reinterpret_cast<const Header *>(bytes);
+        // Unlike load there is no table to reinsert into, so the probe order has to match this build's
+        if (!header->template validate<Data, Probing>(m_Length)) {
+            throw std::runtime_error("Snapshot was written with a different group width or probing policy");
+        }
+
+        m_Controls = reinterpret_cast<const Control *>(bytes + header->controlsOffset);
+        m_Hashes = reinterpret_cast<const HashType *>(bytes + header->hashesOffset);
+        m_Slots = reinterpret_cast<const Slot *>(bytes + header->slotsOffset);
+        m_Size = header->slots;
+        m_Count = header->count;
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap_view<Key, Value, Hash, KeyEqual, Policy>::flashmap_view(flashmap_view && other) noexcept
+    : m_Mapping(std::exchange(other.m_Mapping, nullptr)), m_Length(std::exchange(other.m_Length, 0)),
+      m_Controls(std::exchange(other.m_Controls, nullptr)), m_Hashes(std::exchange(other.m_Hashes, nullptr)),
+      m_Slots(std::exchange(other.m_Slots, nullptr)), m_Size(std::exchange(other.m_Size, 0)),
+      m_Count(std::exchange(other.m_Count, 0)), m_Hasher(std::move(other.m_Hasher)),
+      m_KeyEqual(std::move(other.m_KeyEqual)) {}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap_view<Key, Value, Hash, KeyEqual, Policy> & flashmap_view<Key, Value, Hash, KeyEqual, Policy>::operator=(flashmap_view && other) noexcept {
+    if (this == &other) return *this;
+    unmap();
+    m_Mapping = std::exchange(other.m_Mapping, nullptr);
+    m_Length = std::exchange(other.m_Length, 0);
+    m_Controls = std::exchange(other.m_Controls, nullptr);
+    m_Hashes = std::exchange(other.m_Hashes, nullptr);
+    m_Slots = std::exchange(other.m_Slots, nullptr);
+    m_Size = std::exchange(other.m_Size, 0);
+    m_Count = std::exchange(other.m_Count, 0);
+    m_Hasher = std::move(other.m_Hasher);
+    m_KeyEqual = std::move(other.m_KeyEqual);
+    return *this;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+flashmap_view<Key, Value, Hash, KeyEqual, Policy>::~flashmap_view() {
+    unmap();
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap_view<Key, Value, Hash, KeyEqual, Policy>::const_iterator flashmap_view<Key, Value, Hash, KeyEqual, Policy>::find(const Key & key) const {
+    return const_iterator(this, findIndex(key));
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+bool flashmap_view<Key, Value, Hash, KeyEqual, Policy>::contains(const Key & key) const {
+    return findIndex(key) != m_Size;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+const Value & flashmap_view<Key, Value, Hash, KeyEqual, Policy>::at(const Key & key) const {
+    const std::size_t pos = findIndex(key);
+    if (pos == m_Size) throw std::out_of_range("Key not found");
+    return m_Slots[pos].kv.second;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap_view<Key, Value, Hash, KeyEqual, Policy>::const_iterator flashmap_view<Key, Value, Hash, KeyEqual, Policy>::begin() const {
+    return const_iterator(this, nextFull(0));
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+typename flashmap_view<Key, Value, Hash, KeyEqual, Policy>::const_iterator flashmap_view<Key, Value, Hash, KeyEqual, Policy>::end() const {
+    return const_iterator(this, m_Size);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap_view<Key, Value, Hash, KeyEqual, Policy>::size() const {
+    return m_Count;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap_view<Key, Value, Hash, KeyEqual, Policy>::bucket_count() const {
+    return m_Size;
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap_view<Key, Value, Hash, KeyEqual, Policy>::warmup() const {
+    if (m_Mapping) ::madvise(m_Mapping, m_Length, MADV_WILLNEED);
+}
+
+// PRIVATE METHODS
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap_view<Key, Value, Hash, KeyEqual, Policy>::findIndex(const Key & key) const {
+    if (!m_Mapping) return m_Size;
+    const HashType hash = m_Hasher(key);
+    const std::uint64_t mixed = container::flashmap::impl::mix<Hash>(hash);
+    return container::flashmap::impl::probe<Probing>(m_Controls, m_Size, mixed, [&](const std::size_t pos) {
+        if constexpr (Data::SPLIT_HASHES) {
+            if (m_Hashes[pos] != hash) return false;
+        } else if constexpr (Data::STORE_HASH) {
+            if (m_Slots[pos].hash != hash) return false;
+        }
+        return m_KeyEqual(key, m_Slots[pos].kv.first);
+    });
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+std::size_t flashmap_view<Key, Value, Hash, KeyEqual, Policy>::nextFull(std::size_t index) const {
+    return container::flashmap::impl::nextFull(m_Controls, index, m_Size);
+}
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Policy> requires yulbax::concepts::hashable<Key, Hash>
+void flashmap_view<Key, Value, Hash, KeyEqual, Policy>::unmap() noexcept {
+    if (m_Mapping) ::munmap(m_Mapping, m_Length);
+    m_Mapping = nullptr;
+    m_Length = 0;
+}
@@ -1,128 +1,173 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <cstddef>
-#include <cassert>
+#include <memory>
+#include <new>
 
 namespace yulbax::container::allocator {
+    // Fixed-size node pool owned by one container: nodes are carved out of chunks of CHUNK_SIZE and recycled through a
+    // free list per node size. Chunks come from the upstream allocator and are handed back when the pool dies.
+    // Not synchronized: like the container it serves, it is only used by one thread at a time.
+    template<typename Upstream>
     class chunk_memory_pool {
     public:
         static constexpr std::size_t CHUNK_SIZE = 128;
+        // Node sizes served by one pool; a node-based container needs one, rebinding may add another
+        static constexpr std::size_t MAX_BINS = 4;
 
-        struct FreeNode {
-            FreeNode * next;
-        };
+        explicit chunk_memory_pool(const Upstream & upstream) : m_Upstream(upstream) {}
 
-        template<typename T>
-        struct Chunk {
-            alignas(T) std::byte data[sizeof(T) * CHUNK_SIZE];
-            Chunk * next;
-        };
+        chunk_memory_pool(const chunk_memory_pool &) = delete;
+        chunk_memory_pool & operator=(const chunk_memory_pool &) = delete;
 
-        template<typename T>
-        T * allocate() {
-            auto & state = get_state<T>();
-
-            if (state.freeMem) {
-                FreeNode * node = state.freeMem;
-                state.freeMem = node->next;
-                return reinterpret_cast<T*>(node);
+        ~chunk_memory_pool() {
+            while (m_Chunks) {
+                Chunk * next = m_Chunks->next;
+                Traits::deallocate(m_Upstream, reinterpret_cast<Block*>(m_Chunks), m_Chunks->blocks);
+                m_Chunks = next;
             }
+        }
 
-            if (!state.chunkList || state.usedInChunk == CHUNK_SIZE) {
-                allocChunk<T>();
+        void * allocate(const std::size_t size) {
+            Bin & bin = binFor(size);
+
+            if (bin.freeMem) {
+                FreeNode * node = bin.freeMem;
+                bin.freeMem = node->next;
+                return node;
             }
 
-            T * rawPtr = &reinterpret_cast<T*>(state.chunkList->data)[state.usedInChunk];
-            ++state.usedInChunk;
-            return rawPtr;
+            if (!bin.chunk || bin.usedInChunk == CHUNK_SIZE) allocChunk(bin);
+            return bin.chunk + bin.usedInChunk++ * bin.size;
         }
 
-        template<typename T>
-        void deallocate(T * p) noexcept {
-            auto & state = get_state<T>();
-            auto node = reinterpret_cast<FreeNode*>(p);
-            node->next = state.freeMem;
-            state.freeMem = node;
+        void deallocate(void * p, const std::size_t size) noexcept {
+            Bin & bin = binFor(size);
+            auto * node = static_cast<FreeNode*>(p);
+            node->next = bin.freeMem;
+            bin.freeMem = node;
         }
 
     private:
-        template<typename T>
-        struct TypeState {
+        struct FreeNode {
+            FreeNode * next;
+        };
+
+        // Header of every chunk; the nodes follow it
+        struct alignas(std::max_align_t) Chunk {
+            Chunk * next;
+            std::size_t blocks;
+        };
+
+        struct alignas(std::max_align_t) Block {
+            std::byte data[alignof(std::max_align_t)];
+        };
+
+        struct Bin {
+            std::size_t size = 0;
             FreeNode * freeMem = nullptr;
-            Chunk<T> * chunkList = nullptr;
+            std::byte * chunk = nullptr;
             std::size_t usedInChunk = 0;
-
-            ~TypeState() {
-                while (chunkList) {
-                    auto * next = chunkList->next;
-                    delete chunkList;
-                    chunkList = next;
-                }
-            }
         };
 
-        template<typename T>
-        TypeState<T> & get_state() {
-            static TypeState<T> state;
-            return state;
+        using Traits = std::allocator_traits<typename std::allocator_traits<Upstream>::template rebind_alloc<Block>>;
+
+        static std::size_t roundUp(const std::size_t size) {
+            constexpr std::size_t align = alignof(std::max_align_t);
+            return (std::max(size, sizeof(FreeNode)) + align - 1) / align * align;
         }
 
-        template<typename T>
-        void allocChunk() {
-            auto & state = get_state<T>();
-            auto * newchunk = new Chunk<T>;
-            newchunk->next = state.chunkList;
-            state.chunkList = newchunk;
-            state.usedInChunk = 0;
+        Bin & binFor(const std::size_t size) {
+            const std::size_t rounded = roundUp(size);
+            for (Bin & bin : m_Bins) {
+                if (bin.size == rounded) return bin;
+                if (bin.size == 0) {
+                    bin.size = rounded;
+                    return bin;
+                }
+            }
+            throw std::bad_alloc();
         }
 
-        static chunk_memory_pool & instance() {
-            static chunk_memory_pool pool;
-            return pool;
+        void allocChunk(Bin & bin) {
+            const std::size_t blocks = (sizeof(Chunk) + bin.size * CHUNK_SIZE) / sizeof(Block);
+            auto * chunk = reinterpret_cast<Chunk*>(Traits::allocate(m_Upstream, blocks));
+            chunk->next = m_Chunks;
+            chunk->blocks = blocks;
+            m_Chunks = chunk;
+            bin.chunk = reinterpret_cast<std::byte*>(chunk + 1);
+            bin.usedInChunk = 0;
         }
 
-        template<typename T> friend class chunk_list_allocator;
+        typename Traits::allocator_type m_Upstream;
+        std::array<Bin, MAX_BINS> m_Bins{};
+        Chunk * m_Chunks = nullptr;
     };
 
-    template <typename T>
+    // Single-node allocator for std::list. The pool is created with the allocator, so that every copy and rebind made
+    // from it shares the same one and compares equal to it; it lives as long as the last allocator referring to it.
+    template <typename T, typename Upstream = std::allocator<T>>
     class chunk_list_allocator {
+        using UpstreamTraits = std::allocator_traits<Upstream>;
+        using Pool           = chunk_memory_pool<typename UpstreamTraits::template rebind_alloc<std::byte>>;
     public:
         using value_type = T;
 
-        chunk_list_allocator() = default;
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned nodes are not supported");
 
-        template <typename U>
-        explicit chunk_list_allocator(const chunk_list_allocator<U>&) noexcept {}
+        chunk_list_allocator() : chunk_list_allocator(Upstream()) {}
+
+        explicit chunk_list_allocator(const Upstream & upstream)
+            : m_Upstream(upstream), m_Pool(std::allocate_shared<Pool>(m_Upstream, m_Upstream)) {}
+
+        template <typename U, typename UpstreamU>
+        explicit chunk_list_allocator(const chunk_list_allocator<U, UpstreamU> & other) noexcept
+            : m_Upstream(other.m_Upstream), m_Pool(other.m_Pool) {}
+
+        chunk_list_allocator(const chunk_list_allocator &) = default;
+
+        // std::pmr allocators cannot be assigned, but a container that propagates this one has to replace it
+        chunk_list_allocator & operator=(const chunk_list_allocator & other) noexcept {
+            if (this == &other) return *this;
+            std::destroy_at(&m_Upstream);
+            std::construct_at(&m_Upstream, other.m_Upstream);
+            m_Pool = other.m_Pool;
+            return *this;
+        }
 
         template <typename U>
         struct rebind {
-            using other = chunk_list_allocator<U>;
+            using other = chunk_list_allocator<U, typename UpstreamTraits::template rebind_alloc<U>>;
         };
 
-        static T * allocate(const std::size_t n) {
+        T * allocate(const std::size_t n) {
             if (n != 1) throw std::bad_alloc();
-            return chunk_memory_pool::instance().allocate<T>();
+            return static_cast<T*>(m_Pool->allocate(sizeof(T)));
         }
 
-        static void deallocate(T * p, std::size_t n) noexcept {
-            chunk_memory_pool::instance().deallocate(p);
+        void deallocate(T * p, std::size_t) noexcept {
+            m_Pool->deallocate(p, sizeof(T));
         }
 
-        template <typename U, typename... Args>
-        void construct(U * p, Args&&... args) {
-            ::new (p) U(std::forward<Args>(args)...);
-        }
+        template<typename U, typename UpstreamU>
+        bool operator==(const chunk_list_allocator<U, UpstreamU> & other) const noexcept { return m_Pool == other.m_Pool; }
+        template<typename U, typename UpstreamU>
+        bool operator!=(const chunk_list_allocator<U, UpstreamU> & other) const noexcept { return m_Pool != other.m_Pool; }
 
-        template <typename U>
-        static void destroy(U * p) noexcept {
-            p->~U();
-        }
+        // The pool follows the upstream allocator: it travels with the container wherever the upstream would, and always
+        // when the upstream is stateless. Two pools are never interchangeable, so instances are never always equal.
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::bool_constant<
+            UpstreamTraits::propagate_on_container_move_assignment::value || UpstreamTraits::is_always_equal::value>;
+        using propagate_on_container_swap = std::bool_constant<
+            UpstreamTraits::propagate_on_container_swap::value || UpstreamTraits::is_always_equal::value>;
+        using is_always_equal = std::false_type;
 
-        template<typename U>
-        bool operator==(const chunk_list_allocator<U>&) const noexcept { return true; }
-        template<typename U>
-        bool operator!=(const chunk_list_allocator<U>&) const noexcept { return false; }
+    private:
+        Upstream m_Upstream;
+        std::shared_ptr<Pool> m_Pool;
 
-        using propagate_on_container_move_assignment = std::true_type;
-        using is_always_equal = std::true_type;
+        template <typename U, typename UpstreamU> friend class chunk_list_allocator;
     };
 }
@@ -0,0 +1,60 @@
+// Regression tests for the handle pool under std::pmr allocators.
+#include <cstdint>
+#include <memory_resource>
+#include "flashmap.hpp"
+#include "listallocator.hpp"
+#include "check.hpp"
+
+namespace {
+    using Map = yulbax::pmr::flashmap<std::uint64_t, std::uint64_t>;
+
+    // Moving a per-request map into a long-lived one must leave no handle node in the request's resource
+    void moveAssignAcrossResources() {
+        std::pmr::monotonic_buffer_resource longLivedArena;
+        Map longLived(&longLivedArena);
+        Map::stable_handle first;
+        Map::stable_handle second;
+
+        {
+            std::pmr::monotonic_buffer_resource requestArena;
+            Map perRequest(&requestArena);
+            for (std::uint64_t i = 0; i < 1000; ++i) perRequest.insert(i, i);
+            first = perRequest.find(1);
+            second = perRequest.find(2);
+
+            longLived = std::move(perRequest);
+        }
+
+        FLASHMAP_CHECK(first.valid() && first->second == 1);
+        FLASHMAP_CHECK(second.valid() && second->second == 2);
+
+        // Registering, unregistering and rehashing all walk the handle list that used to live in the request's arena
+        Map::stable_handle third = longLived.find(3);
+        second = Map::stable_handle();
+        for (std::uint64_t i = 1000; i < 10000; ++i) longLived.insert(i, i);
+        FLASHMAP_CHECK(first.valid() && first->second == 1);
+        FLASHMAP_CHECK(third.valid() && third->second == 3);
+    }
+
+    // Copies taken before the first allocation share the pool: they compare equal and free each other's nodes
+    void copiesSharePool() {
+        using Alloc = yulbax::container::allocator::chunk_list_allocator<std::uint64_t>;
+        Alloc original;
+        Alloc copy = original;
+        yulbax::container::allocator::chunk_list_allocator<std::uint32_t, std::allocator<std::uint32_t>> rebound(original);
+        FLASHMAP_CHECK(original == copy);
+        FLASHMAP_CHECK(rebound == original);
+        FLASHMAP_CHECK(Alloc() != original);
+
+        std::uint64_t * node = original.allocate(1);
+        copy.deallocate(node, 1);
+        FLASHMAP_CHECK(copy.allocate(1) == node);
+        original.deallocate(node, 1);
+    }
+}
+
+int main() {
+    moveAssignAcrossResources();
+    copiesSharePool();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// Minimal checks for the regression tests: unlike assert, they stay on in Release builds.
+#include <cstdio>
+#include <cstdlib>
+
+#define FLASHMAP_CHECK(condition)                                                               \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            std::exit(EXIT_FAILURE);                                                            \
+        }                                                                                       \
+    } while (false)
@@ -0,0 +1,67 @@
+// concurrent_flashmap under several writers and readers at once. Build with -fsanitize=thread to check the locking.
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "concurrentflashmap.hpp"
+#include "check.hpp"
+
+namespace {
+    using Map = yulbax::concurrent_flashmap<std::uint64_t, std::uint64_t>;
+
+    constexpr std::uint64_t WORKERS = 4;
+    constexpr std::uint64_t KEYS_PER_WORKER = 20000;
+    constexpr std::uint64_t COUNTERS = 64;
+    constexpr std::uint64_t ROUNDS = 500;
+    // Counters live above every worker's own keys
+    constexpr std::uint64_t COUNTER_BASE = std::uint64_t{1} << 40;
+
+    // Each worker inserts its own key range, erases the odd keys of it and bumps every shared counter, while reading
+    // the ranges of the others; small shards make the writers rehash throughout
+    void mixedWorkload(const bool incremental) {
+        Map map(1024, 16);
+        map.incremental_rehash(incremental);
+
+        {
+            std::vector<std::jthread> workers;
+            for (std::uint64_t worker = 0; worker < WORKERS; ++worker) {
+                workers.emplace_back([&map, worker] {
+                    const std::uint64_t first = worker * KEYS_PER_WORKER;
+                    const std::uint64_t other = (worker + 1) % WORKERS * KEYS_PER_WORKER;
+
+                    for (std::uint64_t i = 0; i < KEYS_PER_WORKER; ++i) {
+                        FLASHMAP_CHECK(map.insert(first + i, first + i));
+                        // Another worker's key is either absent or holds its own value, never anything torn
+                        if (const auto value = map.find(other + i)) FLASHMAP_CHECK(*value == other + i);
+                    }
+                    for (std::uint64_t i = 1; i < KEYS_PER_WORKER; i += 2) FLASHMAP_CHECK(map.erase(first + i));
+                    for (std::uint64_t round = 0; round < ROUNDS; ++round) {
+                        for (std::uint64_t counter = 0; counter < COUNTERS; ++counter) {
+                            map.upsert(COUNTER_BASE + counter, std::uint64_t{1}, [](std::uint64_t & value) { ++value; });
+                        }
+                    }
+                    for (std::uint64_t i = 0; i < KEYS_PER_WORKER; ++i) {
+                        FLASHMAP_CHECK(map.contains(first + i) == (i % 2 == 0));
+                    }
+                });
+            }
+        }
+
+        FLASHMAP_CHECK(map.size() == WORKERS * KEYS_PER_WORKER / 2 + COUNTERS);
+        for (std::uint64_t key = 0; key < WORKERS * KEYS_PER_WORKER; ++key) {
+            const auto value = map.find(key);
+            FLASHMAP_CHECK(value.has_value() == (key % 2 == 0));
+            if (value) FLASHMAP_CHECK(*value == key);
+        }
+        for (std::uint64_t counter = 0; counter < COUNTERS; ++counter) {
+            FLASHMAP_CHECK(map.visit(COUNTER_BASE + counter, [](const std::uint64_t & value) {
+                FLASHMAP_CHECK(value == WORKERS * ROUNDS);
+            }));
+        }
+    }
+}
+
+int main() {
+    mixedWorkload(false);
+    mixedWorkload(true);
+    return EXIT_SUCCESS;
+}
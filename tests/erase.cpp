@@ -0,0 +1,175 @@
+// Erase paths: backward shift under group-linear probing, the tombstone fallbacks, erase while iterating and stable
+// handles on shifted elements, checked against std::unordered_map.
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "flashmap.hpp"
+#include "check.hpp"
+
+namespace {
+    constexpr std::size_t WIDTH = yulbax::container::flashmap::impl::Group::WIDTH;
+    constexpr std::uint64_t HOME_BITS = 0xFFFF;
+
+    // Declared avalanching so that its bits reach the table unmixed. Keys divisible by 3 all start in the last group,
+    // keys one above in the first one, the rest anywhere: long chains that cross group boundaries and wrap around.
+    struct ClusterHash {
+        using is_avalanching = void;
+
+        std::uint64_t operator()(const std::uint64_t key) const {
+            const std::uint64_t spread = (key + 1) * 0x9E3779B97F4A7C15ull;
+            switch (key % 3) {
+                case 0:  return spread | HOME_BITS;
+                case 1:  return spread & ~HOME_BITS;
+                default: return spread;
+            }
+        }
+    };
+
+    template<typename Probing>
+    using Map = yulbax::flashmap<std::uint64_t, std::uint64_t, ClusterHash, std::equal_to<std::uint64_t>,
+                                 std::allocator<std::pair<const std::uint64_t, std::uint64_t>>,
+                                 yulbax::flashmap_policy<yulbax::no_stats, yulbax::auto_layout, Probing>>;
+
+    using LinearMap = Map<yulbax::group_linear_probing>;
+    using TriangularMap = Map<yulbax::triangular_probing>;
+
+    template<typename M>
+    void checkEqual(const M & map, const std::unordered_map<std::uint64_t, std::uint64_t> & reference) {
+        FLASHMAP_CHECK(map.size() == reference.size());
+        for (const auto & [key, value] : reference) FLASHMAP_CHECK(map.contains(key) && map.at(key) == value);
+
+        std::size_t visited = 0;
+        for (const auto & [key, value] : map) {
+            const auto it = reference.find(key);
+            FLASHMAP_CHECK(it != reference.end() && it->second == value);
+            ++visited;
+        }
+        FLASHMAP_CHECK(visited == reference.size());
+    }
+
+    // Random inserts and erases over a small key range, so that most erases hit a key and chains keep shifting
+    template<typename M>
+    void randomAgainstReference(const bool incremental) {
+        std::mt19937_64 rng(0xe7a5e);
+        std::uniform_int_distribution<std::uint64_t> keys(0, 3000);
+        M map(64);
+        map.incremental_rehash(incremental);
+        std::unordered_map<std::uint64_t, std::uint64_t> reference;
+
+        for (std::size_t step = 0; step < 200000; ++step) {
+            const std::uint64_t key = keys(rng);
+            if (rng() % 5 < 3) {
+                FLASHMAP_CHECK(map.insert(key, step) == reference.emplace(key, step).second);
+            } else {
+                FLASHMAP_CHECK(map.erase(key) == (reference.erase(key) == 1));
+            }
+            if (step % 10007 == 0) checkEqual(map, reference);
+        }
+        checkEqual(map, reference);
+    }
+
+    // Fills the home group of keys (all congruent mod 3) and spills `spill` of them into the next one
+    template<typename M>
+    std::vector<std::uint64_t> fillCluster(M & map, const std::uint64_t first, const std::size_t spill) {
+        std::vector<std::uint64_t> keys;
+        for (std::uint64_t key = first; keys.size() < WIDTH + spill; key += 3) {
+            map.insert(key, key);
+            keys.push_back(key);
+        }
+        return keys;
+    }
+
+    // Erasing from a full group shifts an element back from the next group and leaves no tombstone
+    void shiftAcrossGroups() {
+        LinearMap map(4 * WIDTH);
+        const auto keys = fillCluster(map, 1, 4);
+        FLASHMAP_CHECK(map.erase(keys[0]));
+        FLASHMAP_CHECK(map.stats().tombstones == 0);
+        for (std::size_t i = 1; i < keys.size(); ++i) FLASHMAP_CHECK(map.at(keys[i]) == keys[i]);
+    }
+
+    // The only element to shift back lies past the end of the table: the hole becomes a tombstone instead
+    void wrapLeavesTombstone() {
+        LinearMap map(4 * WIDTH);
+        const auto keys = fillCluster(map, 0, 4);
+        FLASHMAP_CHECK(map.erase(keys[0]));
+        FLASHMAP_CHECK(map.stats().tombstones == 1);
+        for (std::size_t i = 1; i < keys.size(); ++i) FLASHMAP_CHECK(map.at(keys[i]) == keys[i]);
+
+        std::size_t visited = 0;
+        for ([[maybe_unused]] const auto & kv : map) ++visited;
+        FLASHMAP_CHECK(visited == keys.size() - 1);
+    }
+
+    // Triangular probing never shifts: a hole in a full group is always a tombstone, one in a group with room never
+    void triangularTombstones() {
+        TriangularMap map(4 * WIDTH);
+        const auto keys = fillCluster(map, 1, 4);
+        FLASHMAP_CHECK(map.erase(keys[0]));
+        FLASHMAP_CHECK(map.stats().tombstones == 1);
+        FLASHMAP_CHECK(map.erase(keys.back()));
+        FLASHMAP_CHECK(map.stats().tombstones == 1);
+        for (std::size_t i = 1; i + 1 < keys.size(); ++i) FLASHMAP_CHECK(map.at(keys[i]) == keys[i]);
+    }
+
+    // Every element is visited exactly once even though erasing pulls later elements back into visited slots
+    template<typename M>
+    void eraseWhileIterating() {
+        M map(64);
+        std::unordered_set<std::uint64_t> kept;
+        for (std::uint64_t key = 0; key < 500; ++key) {
+            map.insert(key, key);
+            if (key % 4) kept.insert(key);
+        }
+
+        std::unordered_set<std::uint64_t> visited;
+        for (auto it = map.begin(); it != map.end(); ++it) {
+            FLASHMAP_CHECK(visited.insert(it->first).second);
+            if (it->first % 4 == 0) {
+                FLASHMAP_CHECK(map.erase(it));
+                FLASHMAP_CHECK(!map.erase(it));
+            }
+        }
+
+        FLASHMAP_CHECK(visited.size() == 500);
+        FLASHMAP_CHECK(map.size() == kept.size());
+        for (const auto key : kept) FLASHMAP_CHECK(map.at(key) == key);
+    }
+
+    // Handles follow the elements that backward shift moves, and report the erased ones
+    template<typename M>
+    void handlesFollowShifts() {
+        M map(64);
+        std::vector<typename M::stable_handle> handles;
+        for (std::uint64_t key = 0; key < 300; ++key) map.insert(key, key);
+        for (std::uint64_t key = 0; key < 300; ++key) handles.emplace_back(map.find(key));
+
+        for (std::uint64_t key = 0; key < 300; key += 2) FLASHMAP_CHECK(map.erase(key));
+
+        for (std::uint64_t key = 0; key < 300; ++key) {
+            if (key % 2 == 0) {
+                FLASHMAP_CHECK(!handles[key].valid());
+            } else {
+                FLASHMAP_CHECK(handles[key].valid());
+                FLASHMAP_CHECK(handles[key]->first == key && handles[key]->second == key);
+            }
+        }
+    }
+}
+
+int main() {
+    randomAgainstReference<LinearMap>(false);
+    randomAgainstReference<LinearMap>(true);
+    randomAgainstReference<TriangularMap>(false);
+    randomAgainstReference<TriangularMap>(true);
+    shiftAcrossGroups();
+    wrapLeavesTombstone();
+    triangularTombstones();
+    eraseWhileIterating<LinearMap>();
+    eraseWhileIterating<TriangularMap>();
+    handlesFollowShifts<LinearMap>();
+    handlesFollowShifts<TriangularMap>();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+// Regression tests for stable handles.
+#include <cstdint>
+#include <memory>
+#include "flashmap.hpp"
+#include "check.hpp"
+
+namespace {
+    using Map = yulbax::flashmap<std::uint64_t, std::uint64_t>;
+
+    // Stateless allocator that counts every allocation made through it or its rebinds
+    inline std::size_t allocations = 0;
+
+    template<typename T>
+    struct CountingAllocator {
+        using value_type = T;
+
+        CountingAllocator() = default;
+        template<typename U>
+        CountingAllocator(const CountingAllocator<U> &) noexcept {}
+
+        T * allocate(const std::size_t n) {
+            ++allocations;
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T * p, const std::size_t n) noexcept {
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        template<typename U>
+        bool operator==(const CountingAllocator<U> &) const noexcept { return true; }
+    };
+
+    using CountedMap = yulbax::flashmap<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>, std::equal_to<std::uint64_t>,
+                                        CountingAllocator<std::pair<const std::uint64_t, std::uint64_t>>>;
+
+    // A first handle on a map whose pool is its own has to draw a chunk; one shared with a map that already holds a
+    // handle would find the node in that map's chunk
+    bool firstHandleAllocates(CountedMap & map, const std::uint64_t key) {
+        const std::size_t before = allocations;
+        const CountedMap::stable_handle handle = map.find(key);
+        return allocations != before;
+    }
+
+    // A handle made from a missed find() sits on end(): rehashing must not read a slot at its index
+    void missedFindSurvivesRehash() {
+        Map map;
+        for (std::uint64_t i = 0; i < 100; ++i) map.insert(i, i);
+
+        Map::stable_handle missing = map.find(1000);
+        Map::const_stable_handle constMissing = std::as_const(map).find(1000);
+        FLASHMAP_CHECK(!missing.valid());
+
+        map.rehash(4096);
+        for (std::uint64_t i = 100; i < 10000; ++i) map.insert(i, i);
+        map.shrink_to_fit();
+
+        FLASHMAP_CHECK(!missing.valid());
+        FLASHMAP_CHECK(!constMissing.valid());
+        FLASHMAP_CHECK(map.size() == 10000);
+    }
+
+    // Same with incremental rehashing, where the handle index is shifted onto the old table and back
+    void missedFindSurvivesMigration() {
+        Map map;
+        map.incremental_rehash(true);
+        Map::stable_handle missing = map.find(42);
+        Map::stable_handle present = map.try_emplace(7, 7).first;
+
+        for (std::uint64_t i = 100; i < 10000; ++i) {
+            map.insert(i, i);
+            if (i % 1000 == 0) map.erase(i - 50);
+        }
+        map.rehash(0);
+
+        FLASHMAP_CHECK(!missing.valid());
+        FLASHMAP_CHECK(present.valid() && present->second == 7);
+    }
+
+    // Moving a map leaves the moved-from map with a pool of its own, for construction and assignment alike
+    void movedFromMapGetsOwnPool() {
+        CountedMap source;
+        source.insert(1, 1);
+        CountedMap constructed(std::move(source));
+        source.insert(2, 2);
+        const CountedMap::stable_handle held = constructed.find(1);
+        FLASHMAP_CHECK(firstHandleAllocates(source, 2));
+
+        CountedMap assigned;
+        assigned = std::move(constructed);
+        constructed.insert(3, 3);
+        FLASHMAP_CHECK(held.valid() && held->second == 1);
+        FLASHMAP_CHECK(firstHandleAllocates(constructed, 3));
+    }
+}
+
+int main() {
+    missedFindSurvivesRehash();
+    missedFindSurvivesMigration();
+    movedFromMapGetsOwnPool();
+    return EXIT_SUCCESS;
+}
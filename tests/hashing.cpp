@@ -0,0 +1,70 @@
+// Regression tests for hash mixing.
+#include <cstdint>
+#include <set>
+#include "flashmap.hpp"
+#include "concurrentflashmap.hpp"
+#include "check.hpp"
+
+namespace {
+    namespace impl = yulbax::container::flashmap::impl;
+
+    constexpr std::size_t SHARD_BITS = 6;
+
+    // Well-mixed 32 bits: the finalizer of MurmurHash3, fmix32, over both halves of the key
+    struct NarrowHash {
+        using is_avalanching = void;
+
+        std::uint32_t operator()(const std::uint64_t key) const {
+            auto x = static_cast<std::uint32_t>(key ^ (key >> 32));
+            x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+            x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+            return x ^ (x >> 16);
+        }
+    };
+
+    struct WideHash {
+        using is_avalanching = void;
+
+        std::uint64_t operator()(const std::uint64_t key) const {
+            return key * 0x9E3779B97F4A7C15ull;
+        }
+    };
+
+    // A narrow avalanching hash still has to spread over the fragment and shard bits at the top
+    void narrowAvalanchingHashIsMixed() {
+        std::set<std::uint8_t> fragments;
+        std::set<std::uint64_t> shards;
+        for (std::uint64_t key = 0; key < 1000; ++key) {
+            const std::uint64_t mixed = impl::mix<NarrowHash>(NarrowHash()(key));
+            fragments.insert(impl::fragment(mixed));
+            shards.insert(mixed >> (57 - SHARD_BITS) & ((1 << SHARD_BITS) - 1));
+        }
+        FLASHMAP_CHECK(fragments.size() > 100);
+        FLASHMAP_CHECK(shards.size() == 1 << SHARD_BITS);
+
+        yulbax::flashmap<std::uint64_t, std::uint64_t, NarrowHash> map;
+        yulbax::concurrent_flashmap<std::uint64_t, std::uint64_t, NarrowHash> concurrent(1 << 12, 1 << SHARD_BITS);
+        for (std::uint64_t key = 0; key < 10000; ++key) {
+            map.insert(key, key);
+            concurrent.insert(key, key);
+        }
+        for (std::uint64_t key = 0; key < 10000; ++key) {
+            FLASHMAP_CHECK(map.at(key) == key);
+            FLASHMAP_CHECK(concurrent.find(key) == key);
+        }
+        FLASHMAP_CHECK(map.size() == 10000 && concurrent.size() == 10000);
+    }
+
+    // A 64-bit avalanching hash is taken as it is
+    void wideAvalanchingHashIsUnmixed() {
+        for (std::uint64_t key = 0; key < 1000; ++key) {
+            FLASHMAP_CHECK(impl::mix<WideHash>(WideHash()(key)) == WideHash()(key));
+        }
+    }
+}
+
+int main() {
+    narrowAvalanchingHashIsMixed();
+    wideAvalanchingHashIsUnmixed();
+    return EXIT_SUCCESS;
+}
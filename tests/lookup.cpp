@@ -0,0 +1,133 @@
+// Heterogeneous lookup: transparent overloads for keys of another type, and the plain ones for the key type itself.
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include "flashmap.hpp"
+#include "check.hpp"
+
+namespace {
+    // Key that counts how often one is built, so that a hidden temporary shows up. Like std::string it is built
+    // implicitly from a C string and is viewable as a std::string_view.
+    struct Name {
+        static inline std::size_t built = 0;
+
+        std::string text;
+
+        explicit Name(const std::string_view value) : text(value) { ++built; }
+        Name(const char * value) : text(value) { ++built; }
+        Name(const Name & other) : text(other.text) { ++built; }
+        Name(Name && other) noexcept = default;
+        Name & operator=(const Name &) = default;
+        Name & operator=(Name &&) noexcept = default;
+
+        bool operator==(const Name &) const = default;
+        operator std::string_view() const { return text; }
+    };
+
+    struct NameHash {
+        std::size_t operator()(const Name & name) const { return std::hash<std::string_view>()(name.text); }
+    };
+
+    struct TransparentHash {
+        using is_transparent = void;
+
+        std::size_t operator()(const std::string_view text) const { return std::hash<std::string_view>()(text); }
+    };
+
+    struct TransparentEqual {
+        using is_transparent = void;
+
+        bool operator()(const std::string_view a, const std::string_view b) const { return a == b; }
+    };
+
+    using PlainMap = yulbax::flashmap<Name, int, NameHash>;
+    using TransparentMap = yulbax::flashmap<Name, int, TransparentHash, TransparentEqual>;
+
+    template<typename M>
+    concept takesStringView = requires(M map, std::string_view key) { map.find(key); map.contains(key); map.erase(key); };
+
+    // Only a map whose hasher and key equality are both transparent takes foreign key types as they are
+    static_assert(takesStringView<TransparentMap>);
+    static_assert(!takesStringView<PlainMap>);
+
+    template<typename M>
+    M build() {
+        M map;
+        for (const char * text : {"alpha", "beta", "gamma", "delta"}) map.insert(Name(text), static_cast<int>(std::string_view(text).size()));
+        return map;
+    }
+
+    // string_view and const char * keys reach the table without building a Name
+    void transparentLookupBuildsNoKey() {
+        TransparentMap map = build<TransparentMap>();
+        const std::string_view beta = "beta";
+
+        const std::size_t before = Name::built;
+        FLASHMAP_CHECK(map.contains(beta) && !map.contains(std::string_view("omega")));
+        FLASHMAP_CHECK(map.find(beta) != map.end() && map.find(beta)->second == 4);
+        FLASHMAP_CHECK(std::as_const(map).find("gamma")->second == 5);
+        FLASHMAP_CHECK(map.at(beta) == 4 && std::as_const(map).at("alpha") == 5);
+        FLASHMAP_CHECK(map.erase(std::string_view("delta")) && !map.erase(std::string_view("delta")));
+        FLASHMAP_CHECK(Name::built == before);
+
+        bool threw = false;
+        try {
+            static_cast<void>(map.at(std::string_view("omega")));
+        } catch (const std::out_of_range &) {
+            threw = true;
+        }
+        FLASHMAP_CHECK(threw && map.size() == 3);
+
+        // operator[] builds the key only when it inserts
+        map[beta] = 40;
+        FLASHMAP_CHECK(Name::built == before);
+        map[std::string_view("epsilon")] = 7;
+        FLASHMAP_CHECK(Name::built == before + 1 && map.at("epsilon") == 7 && map.at(beta) == 40);
+    }
+
+    // The key type itself still goes through the plain overloads, on either map
+    template<typename M>
+    void keyTypeLookup() {
+        M map = build<M>();
+        const Name beta("beta");
+        const Name omega("omega");
+
+        FLASHMAP_CHECK(map.contains(beta) && !map.contains(omega));
+        FLASHMAP_CHECK(map.find(beta)->second == 4 && map.find(omega) == map.end());
+        FLASHMAP_CHECK(map.at(beta) == 4);
+        FLASHMAP_CHECK(map.erase(beta) && !map.contains(beta) && map.size() == 3);
+
+        // Without transparency a const char * is converted to the key type first
+        const std::size_t before = Name::built;
+        FLASHMAP_CHECK(map.contains("alpha"));
+        if constexpr (std::is_same_v<M, PlainMap>) FLASHMAP_CHECK(Name::built == before + 1);
+        else FLASHMAP_CHECK(Name::built == before);
+    }
+
+    // A hash taken once from hash_function() serves find, contains and insert_with_hash, on several maps
+    void precomputedHash() {
+        TransparentMap first = build<TransparentMap>();
+        TransparentMap second;
+        const std::string_view key = "gamma";
+        const auto hash = first.hash_function()(key);
+
+        FLASHMAP_CHECK(first.find(key, hash)->second == 5 && first.contains(key, hash));
+        FLASHMAP_CHECK(std::as_const(first).find(key, hash) != std::as_const(first).end());
+        FLASHMAP_CHECK(!second.contains(key, hash));
+        FLASHMAP_CHECK(second.insert_with_hash(Name(key), 9, hash) && !second.insert_with_hash(Name(key), 10, hash));
+        FLASHMAP_CHECK(second.at(key) == 9 && second.find(Name(key), hash)->second == 9);
+
+        PlainMap plain = build<PlainMap>();
+        const Name name("beta");
+        FLASHMAP_CHECK(plain.find(name, plain.hash_function()(name))->second == 4);
+    }
+}
+
+int main() {
+    transparentLookupBuildsNoKey();
+    keyTypeLookup<PlainMap>();
+    keyTypeLookup<TransparentMap>();
+    precomputedHash();
+    return EXIT_SUCCESS;
+}
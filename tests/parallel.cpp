@@ -0,0 +1,114 @@
+// parallel_for_each and parallel_reduce against a serial pass over the same map.
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include "flashmap.hpp"
+#include "check.hpp"
+
+namespace {
+    using Map = yulbax::flashmap<std::uint64_t, std::uint64_t>;
+
+    // Slots per worker claim, as flashmap::PARALLEL_CHUNK
+    constexpr std::size_t CHUNK = 1 << 14;
+
+    // x -> a * x + b modulo 2^64. Composition is associative but not commutative, so the result also shows that the
+    // elements were combined in the order a plain loop visits them.
+    struct Affine {
+        std::uint64_t a = 1;
+        std::uint64_t b = 0;
+
+        bool operator==(const Affine &) const = default;
+    };
+
+    Affine compose(const Affine & first, const Affine & then) {
+        return {then.a * first.a, then.a * first.b + then.b};
+    }
+
+    Affine affineOf(const std::pair<const std::uint64_t, std::uint64_t> & kv) {
+        return {kv.first * 2 + 1, kv.second};
+    }
+
+    void checkAgainstSerial(Map & map) {
+        Affine serial;
+        std::uint64_t sum = 0;
+        for (const auto & kv : map) {
+            serial = compose(serial, affineOf(kv));
+            sum += kv.second;
+        }
+
+        for (const std::size_t threads : {std::size_t{0}, std::size_t{1}, std::size_t{2}, std::size_t{4}}) {
+            FLASHMAP_CHECK(map.parallel_reduce(Affine(), compose, affineOf, threads) == serial);
+            FLASHMAP_CHECK(map.parallel_reduce(std::uint64_t{0}, std::plus<>(),
+                                               [](const auto & kv) { return kv.second; }, threads) == sum);
+        }
+
+        // Every element is visited exactly once: doubling each value doubles the sum, whatever the worker count
+        std::unordered_map<std::uint64_t, std::uint64_t> before(map.begin(), map.end());
+        map.parallel_for_each([](auto & kv) { kv.second = kv.second * 2 + 1; }, 3);
+        FLASHMAP_CHECK(map.size() == before.size());
+        for (const auto & [key, value] : before) FLASHMAP_CHECK(map.at(key) == value * 2 + 1);
+
+        std::atomic<std::uint64_t> total = 0;
+        std::atomic<std::size_t> visited = 0;
+        std::as_const(map).parallel_for_each([&](const auto & kv) {
+            total += kv.second;
+            ++visited;
+        }, 2);
+        FLASHMAP_CHECK(visited == map.size() && total == sum * 2 + map.size());
+    }
+
+    // Fewer slots than one chunk: a single worker does all the work
+    void smallTable() {
+        Map map(64);
+        for (std::uint64_t key = 0; key < 40; ++key) map.insert(key, key * key);
+        FLASHMAP_CHECK(map.bucket_count() < CHUNK);
+        checkAgainstSerial(map);
+
+        Map empty;
+        FLASHMAP_CHECK(empty.parallel_reduce(Affine{3, 4}, compose, affineOf, 4) == (Affine{3, 4}));
+    }
+
+    // Many chunks, some emptied by erases
+    void largeTable() {
+        Map map;
+        for (std::uint64_t key = 0; key < 200000; ++key) map.insert(key * 7919, key);
+        for (std::uint64_t key = 0; key < 200000; key += 3) map.erase(key * 7919);
+        FLASHMAP_CHECK(map.bucket_count() > 4 * CHUNK);
+        checkAgainstSerial(map);
+    }
+
+    // Halfway through an incremental rehash the scan covers both tables
+    void migratingTable() {
+        Map map;
+        map.incremental_rehash(true);
+        for (std::uint64_t key = 0; !map.stats().migrating || key < 100000; ++key) map.insert(key, key + 1);
+        FLASHMAP_CHECK(map.stats().migrating);
+        checkAgainstSerial(map);
+        FLASHMAP_CHECK(map.stats().migrating);
+    }
+
+    // An exception from fn reaches the caller once the workers have stopped
+    void exceptionPropagates() {
+        Map map;
+        for (std::uint64_t key = 0; key < 100000; ++key) map.insert(key, key);
+
+        bool threw = false;
+        try {
+            map.parallel_for_each([](const auto & kv) {
+                if (kv.first == 4242) throw std::runtime_error("stop");
+            }, 4);
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+        FLASHMAP_CHECK(threw && map.size() == 100000);
+    }
+}
+
+int main() {
+    smallTable();
+    largeTable();
+    migratingTable();
+    exceptionPropagates();
+    return EXIT_SUCCESS;
+}
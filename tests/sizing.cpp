@@ -0,0 +1,42 @@
+// Regression tests for table sizes at the edge of std::size_t.
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include "flashmap.hpp"
+#include "check.hpp"
+
+namespace {
+    using Map = yulbax::flashmap<std::uint64_t, std::uint64_t>;
+
+    template<typename F>
+    bool throwsLengthError(F && fn) {
+        try {
+            fn();
+        } catch (const std::length_error &) {
+            return true;
+        }
+        return false;
+    }
+
+    // Sizes no table can have throw instead of overflowing, and leave the map usable
+    void impossibleSizesThrow() {
+        constexpr std::size_t max = std::numeric_limits<std::size_t>::max();
+        Map map;
+        map.insert(1, 1);
+        map.max_load_factor(0.01f);
+
+        FLASHMAP_CHECK(throwsLengthError([&] { map.reserve(max / 2); }));
+        FLASHMAP_CHECK(throwsLengthError([&] { map.reserve(max); }));
+        FLASHMAP_CHECK(throwsLengthError([&] { map.rehash(max); }));
+        FLASHMAP_CHECK(throwsLengthError([] { Map tooLarge(max); }));
+
+        FLASHMAP_CHECK(map.size() == 1 && map.at(1) == 1);
+        map.reserve(1000);
+        FLASHMAP_CHECK(map.bucket_count() >= 100000);
+    }
+}
+
+int main() {
+    impossibleSizesThrow();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+// Snapshots: save/load round trips, flashmap_view lookups and the headers and files both must reject.
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include "flashmap.hpp"
+#include "flashmapview.hpp"
+#include "check.hpp"
+
+namespace {
+    using Map = yulbax::flashmap<std::uint64_t, std::uint64_t>;
+    using View = yulbax::flashmap_view<std::uint64_t, std::uint64_t>;
+    using Header = yulbax::container::flashmap::impl::SnapshotHeader;
+
+    std::filesystem::path snapshotPath(const std::string & name) {
+        return std::filesystem::temp_directory_path() / ("flashmap_test_" + name + ".snap");
+    }
+
+    // Runs fn and reports whether it threw std::runtime_error with message in its text
+    template<typename F>
+    bool rejects(F && fn, const std::string & message) {
+        try {
+            fn();
+        } catch (const std::runtime_error & error) {
+            return std::string(error.what()).find(message) != std::string::npos;
+        }
+        return false;
+    }
+
+    template<typename M>
+    void checkSame(const Map & source, const M & copy) {
+        FLASHMAP_CHECK(copy.size() == source.size());
+        std::size_t visited = 0;
+        for (const auto & [key, value] : copy) {
+            FLASHMAP_CHECK(source.contains(key) && source.at(key) == value);
+            ++visited;
+        }
+        FLASHMAP_CHECK(visited == source.size());
+        for (const auto & [key, value] : source) FLASHMAP_CHECK(copy.contains(key) && copy.at(key) == value);
+    }
+
+    void roundTrip(const Map & source, const std::string & name) {
+        const auto path = snapshotPath(name);
+        source.save(path);
+        checkSame(source, Map::load(path));
+        checkSame(source, View(path));
+        std::filesystem::remove(path);
+    }
+
+    // Empty, populated with some elements erased, and saved halfway through an incremental rehash
+    void roundTrips() {
+        roundTrip(Map(), "empty");
+
+        Map populated;
+        for (std::uint64_t key = 0; key < 5000; ++key) populated.insert(key, key * 3);
+        for (std::uint64_t key = 0; key < 5000; key += 7) populated.erase(key);
+        roundTrip(populated, "populated");
+
+        Map migrating;
+        migrating.incremental_rehash(true);
+        for (std::uint64_t key = 0; !migrating.stats().migrating; ++key) migrating.insert(key, key + 1);
+        roundTrip(migrating, "migrating");
+        FLASHMAP_CHECK(migrating.stats().migrating);
+    }
+
+    // The view probes the mapped table directly: hits, misses and at() have to agree with the source map
+    void viewLookups() {
+        Map source;
+        for (std::uint64_t key = 0; key < 20000; key += 2) source.insert(key, ~key);
+        const auto path = snapshotPath("view");
+        source.save(path);
+
+        const View view(path);
+        FLASHMAP_CHECK(view.size() == source.size() && view.bucket_count() == source.bucket_count());
+        for (std::uint64_t key = 0; key < 20000; ++key) {
+            FLASHMAP_CHECK(view.contains(key) == source.contains(key));
+            if (key % 2 == 0) FLASHMAP_CHECK(view.at(key) == ~key && view.find(key)->second == ~key);
+            else FLASHMAP_CHECK(view.find(key) == view.end());
+        }
+
+        bool threw = false;
+        try {
+            static_cast<void>(view.at(1));
+        } catch (const std::out_of_range &) {
+            threw = true;
+        }
+        FLASHMAP_CHECK(threw);
+        std::filesystem::remove(path);
+    }
+
+    // A file cut short anywhere, in the header or in the arrays, is corrupt
+    void truncatedFile() {
+        Map source;
+        for (std::uint64_t key = 0; key < 1000; ++key) source.insert(key, key);
+        const auto path = snapshotPath("truncated");
+
+        for (const std::uintmax_t cut : {std::uintmax_t{1}, std::uintmax_t{sizeof(Header) + 1}}) {
+            source.save(path);
+            std::filesystem::resize_file(path, std::filesystem::file_size(path) - cut);
+            FLASHMAP_CHECK(rejects([&] { Map::load(path); }, "corrupt"));
+            FLASHMAP_CHECK(rejects([&] { View view(path); }, "corrupt"));
+        }
+
+        std::filesystem::resize_file(path, sizeof(Header) / 2);
+        FLASHMAP_CHECK(rejects([&] { Map::load(path); }, "corrupt"));
+        FLASHMAP_CHECK(rejects([&] { View view(path); }, "corrupt"));
+        std::filesystem::remove(path);
+    }
+
+    // Overwrites one header field of a fresh snapshot
+    template<typename T>
+    void patchHeader(const std::filesystem::path & path, const Map & source, const std::size_t offset, const T value) {
+        source.save(path);
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    // Headers that do not describe this table type: wrong magic, version, byte order, sizes, layout or slot count
+    void badHeaders() {
+        Map source;
+        for (std::uint64_t key = 0; key < 1000; ++key) source.insert(key, key);
+        const auto path = snapshotPath("header");
+
+        const auto check = [&](const std::string & message) {
+            FLASHMAP_CHECK(rejects([&] { Map::load(path); }, message));
+            FLASHMAP_CHECK(rejects([&] { View view(path); }, message));
+        };
+
+        patchHeader(path, source, offsetof(Header, magic), 'X');
+        check("Not a flashmap snapshot");
+        patchHeader(path, source, offsetof(Header, version), Header::VERSION + 1);
+        check("Unsupported snapshot version");
+        patchHeader(path, source, offsetof(Header, byteOrder), std::uint32_t{0x04030201});
+        check("byte order");
+        patchHeader(path, source, offsetof(Header, valueSize), std::uint64_t{4});
+        check("different key or value types");
+        patchHeader(path, source, offsetof(Header, slots), std::uint64_t{1000});
+        check("corrupt");
+        patchHeader(path, source, offsetof(Header, count), std::uint64_t{1} << 40);
+        check("corrupt");
+
+        // Saved by another map type: other value size, other layout
+        source.save(path);
+        FLASHMAP_CHECK(rejects([&] { yulbax::flashmap<std::uint64_t, std::uint32_t>::load(path); }, "different key or value types"));
+        using Stored = yulbax::flashmap_policy<yulbax::no_stats, yulbax::soa_layout<true>>;
+        FLASHMAP_CHECK(rejects([&] {
+            yulbax::flashmap<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>, std::equal_to<std::uint64_t>,
+                             std::allocator<std::pair<const std::uint64_t, std::uint64_t>>, Stored>::load(path);
+        }, "different layout"));
+
+        // Another probing policy: load reinserts, the view cannot
+        using Triangular = yulbax::flashmap_policy<yulbax::no_stats, yulbax::auto_layout, yulbax::triangular_probing>;
+        FLASHMAP_CHECK(rejects([&] {
+            yulbax::flashmap_view<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>, std::equal_to<std::uint64_t>, Triangular> view(path);
+        }, "probing policy"));
+        checkSame(source, yulbax::flashmap<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>, std::equal_to<std::uint64_t>,
+                                           std::allocator<std::pair<const std::uint64_t, std::uint64_t>>, Triangular>::load(path));
+        std::filesystem::remove(path);
+    }
+}
+
+int main() {
+    roundTrips();
+    viewLookups();
+    truncatedFile();
+    badHeaders();
+    return EXIT_SUCCESS;
+}